@@ -24,10 +24,34 @@
 
 #include "Arduino.h"
 #include <Wire.h>
+#ifndef CST816S_NO_USER_ISR
 #include <FunctionalInterrupt.h>
+#endif
 
 #include "CST816S.h"
 
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#endif
+
+// Bus clocks tried from fastest to slowest: Fast-mode Plus, Fast-mode, Standard-mode
+static const uint32_t i2c_clocks[] = {1000000, 400000, 100000};
+#define I2C_CLOCK_COUNT (sizeof(i2c_clocks) / sizeof(i2c_clocks[0]))
+
+/*!
+    @brief  microsecond timestamp for events, safe to call from interrupts
+*/
+static inline uint32_t IRAM_ATTR timestamp_us()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return (uint32_t)esp_timer_get_time();
+#else
+    return micros();
+#endif
+}
+
 /*!
     @brief  Constructor for CST816S
   @param	sda
@@ -42,7 +66,9 @@
 // Added TwoWire reference
 CST816S::CST816S(int sda, int scl, int rst, int irq, TwoWire &wire) : _wire(wire)
 {
+#ifndef CST816S_NO_ROTATION
     _rotation = 0;
+#endif
     _sda = sda;
     _scl = scl;
     _rst = rst;
@@ -51,13 +77,18 @@ CST816S::CST816S(int sda, int scl, int rst, int irq, TwoWire &wire) : _wire(wire
 
 CST816S::CST816S(int sda, int scl, int rst, int irq, int rotation, TwoWire &wire) : _wire(wire)
 {
+#ifndef CST816S_NO_ROTATION
     _rotation = rotation;
+#else
+    (void)rotation;
+#endif
     _sda = sda;
     _scl = scl;
     _rst = rst;
     _irq = irq;
 }
 
+#ifndef CST816S_NO_ROTATION
 void CST816S::setSize(int w, int h)
 {
     _width = w;
@@ -66,65 +97,575 @@ void CST816S::setSize(int w, int h)
 
 uint8_t CST816S::rotateGesture(uint8_t gestureID)
 {
-    static const uint8_t rotation90[5] = {0, 0x03, 0x04, 0x02, 0x01};
-    static const uint8_t rotation180[5] = {0, 0x02, 0x01, 0x04, 0x03};
-    static const uint8_t rotation270[5] = {0, 0x04, 0x03, 0x01, 0x02};
-    // checking if non rotation specific gesture
-    if (gestureID < 1 || gestureID > 4 || _rotation == 0)
+    return cst816s_rotate_gesture(gestureID, _rotation);
+}
+
+void CST816S::rotatePoint(int &x, int &y)
+{
+    cst816s_rotate_point(x, y, _rotation, _width, _height);
+}
+#else
+uint8_t CST816S::rotateGesture(uint8_t gestureID)
+{
+    return gestureID;
+}
+
+void CST816S::rotatePoint(int & /*x*/, int & /*y*/)
+{
+}
+#endif
+
+/*!
+    @brief  read touch data
+    @return false if the report could not be read or was not valid
+*/
+bool CST816S::read_touch()
+{
+    raw_frame frame;
+    fetch_frame(frame);
+    return process_frame(frame);
+}
+
+/*!
+    @brief  transfer a report and any further touch points from the controller, no decoding
+  @param	frame
+      filled with the raw registers, the interrupt time and the transfer result
+*/
+void CST816S::fetch_frame(raw_frame &frame)
+{
+    frame.error = 0;
+#if CST816S_MAX_POINTS > 1
+    frame.extraPoints = 0;
+#endif
+    // when the controller signalled the report, not when it was read; taken before the transfer, during
+    // which the interrupt of the next report may already arrive
+    frame.timestamp = _irq_time;
+    // the error comes back with the transfer, the reader task and the caller of available() may both be on the bus
+    frame.error = i2c_read(CST816S_ADDRESS, CST816S_REG_GESTURE_ID::address, frame.report, 6);
+#if CST816S_MAX_POINTS > 1
+    uint8_t count = frame.report[1] < CST816S_MAX_POINTS ? frame.report[1] : CST816S_MAX_POINTS;
+    uint8_t limit = _max_points != 0 ? _max_points : _chip->maxPoints;
+    if (count > limit)
     {
-        return gestureID;
+        count = limit; // the part reports no further points, whatever the count register holds
     }
+    if (frame.error == 0 && CST816S_EVENT_FLAG::decode(frame.report[2]) != 3 && count > 1)
+    {
+        // further points follow at 0x09, 6 bytes apart, only their first 4 bytes are needed
+        if (i2c_read(CST816S_ADDRESS, CST816S_REG_XPOS_H2::address, frame.extra, 6 * (count - 1) - 2) == 0)
+        {
+            frame.extraPoints = count - 1;
+        }
+    }
+#endif
+}
 
-    switch (_rotation)
+/*!
+    @brief  decode, filter and dispatch a report transferred by fetch_frame()
+    @param  injected  the frame comes from inject(), it says nothing about the bus
+    @return false if the report was not valid or is not wanted by the event mask
+*/
+bool CST816S::process_frame(raw_frame &frame, bool injected)
+{
+    bool ok = frame.error == 0;
+    if (_trace_cb != nullptr)
+    {
+        trace_record record;
+        if (!ok)
+        {
+            memset(frame.report, 0, 6);
+        }
+        cst816s_trace_record(record, frame.timestamp, frame.report, ok ? 0 : CST816S_TRACE_FLAG_ERROR);
+        _trace_cb(record, _trace_arg);
+    }
+    if (!ok)
+    {
+        read_failed(frame.error, frame.timestamp);
+        return false;
+    }
+    if (CST816S_EVENT_FLAG::decode(frame.report[2]) == 3)
+    {
+        // event 3 is reserved, seen on spurious interrupts and while the controller resets
+        _errors.invalidFrame++;
+        read_failed(ERROR_INVALID_FRAME, frame.timestamp);
+        return false;
+    }
+    if (!injected)
     {
-    case 1:
-        return rotation90[gestureID];
-    case 2:
-        return rotation180[gestureID];
-    case 3:
-        return rotation270[gestureID];
-    default:
-        return gestureID; // No rotation or unknown rotation
+        // only a good read shows the bus and the controller recovered
+        _read_errors = 0;
+        _read_bus_errors = 0;
     }
+
+    touch_event event;
+    cst816s_decode(frame.report, event);
+    event.timestamp = frame.timestamp;
+    event.gestureID = rotateGesture(event.gestureID);
+    rotatePoint(event.x, event.y);
+
+    data.touchCount = read_points(frame);
+    return publish(event);
 }
 
-void CST816S::rotatePoint(int &x, int &y)
+/*!
+    @brief  make a decoded event current in data, then queue and dispatch it unless masked
+    @return false if the event mask filtered it out
+*/
+bool CST816S::publish(const touch_event &event)
 {
-    int oldX = x;
-    int oldY = y;
-    switch (_rotation)
+    data.gestureID = event.gestureID;
+    data.points = event.points;
+    data.event = event.event;
+    data.x = event.x;
+    data.y = event.y;
+
+    uint8_t classes = cst816s_event_class(event, _last_gesture);
+    _last_gesture = event.gestureID;
+    if (!(classes & _event_mask))
     {
-    case 1:
-        x = oldY;
-        y = _width - 1 - oldX;
-        break;
-    case 2:
-        x = _width  - 1 - oldX;
-        y = _height - 1 - oldY;
-        break;
-    case 3:
-        x = _height - 1 - oldY;
-        y = oldX;
-        break;
-    default: // No rotation or unknown rotation
-        break;
+        return false;
     }
+    push_event(event, classes);
+    dispatch(event, classes);
+    return true;
 }
 
 /*!
-    @brief  read touch data
+    @brief  Feed a report frame into the pipeline as if it had been read from the controller:
+            it is traced, validated, decoded, rotated, filtered, queued and dispatched. Call it
+            from the context that calls available().
+  @param	frame
+      6 bytes as read from register 0x01: gesture, points, XH, XL, YH, YL
+  @param	timestamp
+      event time in us, e.g. consecutive synthetic times to replay faster than real time
+  @return true if the frame produced an event
+*/
+bool CST816S::inject(const uint8_t *frame, uint32_t timestamp)
+{
+    raw_frame raw;
+    memcpy(raw.report, frame, sizeof(raw.report));
+    raw.timestamp = timestamp;
+    raw.error = 0;
+#if CST816S_MAX_POINTS > 1
+    raw.extraPoints = 0;
+#endif
+    if (CST816S_EVENT_FLAG::decode(raw.report[2]) == 3)
+    {
+        // reported like a read one, but synthetic frames never trigger a bus recovery
+        _errors.invalidFrame++;
+        dispatch_error(ERROR_INVALID_FRAME, timestamp);
+        return false;
+    }
+    return process_frame(raw, true);
+}
+
+/*!
+    @brief  Feed a decoded event into the pipeline, bypassing decoding and rotation: it becomes
+            data and the single touch point, then is filtered, queued and dispatched.
+  @return true if the event passed the event mask
+*/
+bool CST816S::inject(const touch_event &event)
+{
+    data.touches[0].id = 0;
+    data.touches[0].event = event.event;
+    data.touches[0].x = event.x;
+    data.touches[0].y = event.y;
+    data.touchCount = 1;
+    return publish(event);
+}
+
+/*!
+    @brief  decode all touch points of a frame into data.touches
+  @return number of points decoded
+*/
+uint8_t CST816S::read_points(const raw_frame &frame)
+{
+    cst816s_decode_point(frame.report + 2, data.touches[0]);
+    rotatePoint(data.touches[0].x, data.touches[0].y);
+
+    uint8_t count = 1;
+#if CST816S_MAX_POINTS > 1
+    for (int i = 0; i < frame.extraPoints; i++, count++)
+    {
+        cst816s_decode_point(frame.extra + 6 * i, data.touches[count]);
+        rotatePoint(data.touches[count].x, data.touches[count].y);
+    }
+#endif
+    return count;
+}
+
+/*!
+    @brief  hand a decoded touch event and its points to the sinks subscribed to its classes
+*/
+void CST816S::dispatch(const touch_event &event, uint8_t classes)
+{
+    for (int i = 0; i < CST816S_MAX_SINKS; i++)
+    {
+        if (_sinks[i] == nullptr)
+        {
+            continue;
+        }
+        if (!(_sink_masks[i] & classes))
+        {
+            _sink_wakeups_filtered++;
+            continue;
+        }
+        _sink_wakeups++;
+        _sinks[i]->onTouchEvent(event);
+        _sinks[i]->onTouchPoints(data.touches, data.touchCount, event.timestamp);
+    }
+}
+
+/*!
+    @brief  report a driver error to the attached sinks
+*/
+void CST816S::dispatch_error(uint8_t error, uint32_t timestamp)
+{
+    for (int i = 0; i < CST816S_MAX_SINKS; i++)
+    {
+        if (_sinks[i] != nullptr)
+        {
+            _sinks[i]->onTouchError(error, timestamp);
+        }
+    }
+}
+
+/*!
+    @brief  Attaches a consumer that receives decoded touch events.
+    @param  sink  Called from the context that reads the touch data (available()).
+    @param  mask  CST816S_EVENT_* classes the sink is interested in, other events do not reach it
+    @return false if CST816S_MAX_SINKS sinks are already attached
+*/
+bool CST816S::addSink(CST816S_Sink *sink, uint8_t mask)
+{
+    int free = -1;
+    for (int i = 0; i < CST816S_MAX_SINKS; i++)
+    {
+        if (_sinks[i] == sink)
+        {
+            _sink_masks[i] = mask;
+            return true;
+        }
+        if (_sinks[i] == nullptr && free < 0)
+        {
+            free = i;
+        }
+    }
+    if (free < 0)
+    {
+        return false;
+    }
+    _sinks[free] = sink;
+    _sink_masks[free] = mask;
+    return true;
+}
+
+/*!
+    @brief  Select the events the application needs at all.
+    @param  mask  CST816S_EVENT_* classes; others are not queued or dispatched, and where the
+                  controller supports it (IrqCtl) they no longer raise an interrupt. Without
+                  CST816S_EVENT_GESTURE the double click and continuous swipe recognition enabled
+                  in MotionMask is switched off until the gestures are selected again.
+*/
+void CST816S::setEventMask(uint8_t mask)
+{
+    _event_mask = mask;
+#ifndef CST816S_NO_CONFIG
+    write_motion_mask();
+#endif
+    if (!_chip->irqControl)
+    {
+        return;
+    }
+
+    cst816s_value<CST816S_REG_IRQ_CTL> irqCtl =
+        CST816S_EN_TOUCH::set((mask & CST816S_EVENT_MOVE) != 0) |
+        CST816S_EN_CHANGE::set((mask & CST816S_EVENT_EDGE) != 0) |
+        CST816S_EN_MOTION::set((mask & (CST816S_EVENT_GESTURE | CST816S_EVENT_LONG_PRESS)) != 0) |
+        CST816S_ONCE_WLP::set((mask & CST816S_EVENT_LONG_PRESS) && !(mask & CST816S_EVENT_MOVE));
+    _irq_ctl = irqCtl.bits;
+    write_reg(irqCtl);
+}
+
+#ifndef CST816S_NO_CONFIG
+/*!
+    @brief  write the MotionMask set by the configuration API, cleared while the event mask excludes gestures
+*/
+void CST816S::write_motion_mask()
+{
+    if (_motion_mask < 0)
+    {
+        return; // never configured, leave the controller default
+    }
+    uint8_t bits = (_event_mask & CST816S_EVENT_GESTURE) ? _motion_mask : 0;
+    write_reg(cst816s_value<CST816S_REG_MOTION_MASK>{bits});
+}
+#endif
+
+/*!
+    @brief  number of times a sink was handed an event
+*/
+uint32_t CST816S::sinkWakeups()
+{
+    return _sink_wakeups;
+}
+
+/*!
+    @brief  number of times a sink was not woken because its mask excluded the event
+*/
+uint32_t CST816S::sinkWakeupsFiltered()
+{
+    return _sink_wakeups_filtered;
+}
+
+/*!
+    @brief  Detaches a consumer added with addSink().
+*/
+void CST816S::removeSink(CST816S_Sink *sink)
+{
+    for (int i = 0; i < CST816S_MAX_SINKS; i++)
+    {
+        if (_sinks[i] == sink)
+        {
+            _sinks[i] = nullptr;
+        }
+    }
+}
+
+/*!
+    @brief  account for a report that was lost, recover after repeated failures
+*/
+void CST816S::read_failed(uint8_t error, uint32_t timestamp)
+{
+    lock_queue(); // also counted by the reader task
+    _errors.lostEvents++;
+    unlock_queue();
+    if (error != ERROR_INVALID_FRAME)
+    {
+        _read_bus_errors++;
+    }
+    dispatch_error(error, timestamp);
+    if (++_read_errors >= CST816S_MAX_READ_ERRORS)
+    {
+        recover();
+        dispatch_error(ERROR_RECOVERY, timestamp_us());
+    }
+}
+
+/*!
+    @brief  free the bus, reset the controller and restore its configuration
+*/
+void CST816S::recover()
+{
+    unsigned long start = millis();
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // keep the reader task off the bus until the controller is configured again
+    lock_queue();
+    _recovering = true;
+    unlock_queue();
+    while (_fetching)
+    {
+        delay(1);
+    }
+    _wire.end(); // release the pins so they can be driven directly
+#endif
+    bus_clear();
+    if (_read_bus_errors > 0 && _clock_index < I2C_CLOCK_COUNT - 1)
+    {
+        _clock_index++; // transfers failed, retry at the next lower clock
+    }
+    _wire.begin(_sda, _scl, i2c_clocks[_clock_index]);
+    reset();
+
+#ifndef CST816S_NO_CONFIG
+    write_motion_mask();
+    if (_auto_sleep_time >= 0)
+    {
+        write_reg(CST816S_AUTO_SLEEP_TIME::set(_auto_sleep_time));
+    }
+    if (_dis_auto_sleep >= 0)
+    {
+        write_reg(CST816S_DIS_AUTO_SLEEP::set(_dis_auto_sleep));
+    }
+#endif
+    if (_irq_ctl >= 0)
+    {
+        write_reg(cst816s_value<CST816S_REG_IRQ_CTL>{(uint8_t)_irq_ctl});
+    }
+    if (_gesture_wake)
+    {
+        write_gesture_wake();
+    }
+
+    _read_errors = 0;
+    _read_bus_errors = 0;
+    _errors.recoveries++;
+    _errors.recoveryTime = millis() - start;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    lock_queue();
+    _recovering = false;
+    unlock_queue();
+#endif
+}
+
+/*!
+    @brief  clock out a slave holding SDA low and generate a stop condition
+*/
+void CST816S::bus_clear()
+{
+    pinMode(_sda, INPUT_PULLUP);
+    pinMode(_scl, OUTPUT);
+    for (int i = 0; i < 9 && digitalRead(_sda) == LOW; i++)
+    {
+        digitalWrite(_scl, LOW);
+        delayMicroseconds(5);
+        digitalWrite(_scl, HIGH);
+        delayMicroseconds(5);
+    }
+    pinMode(_sda, OUTPUT);
+    digitalWrite(_sda, LOW);
+    delayMicroseconds(5);
+    digitalWrite(_scl, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(_sda, HIGH);
+    delayMicroseconds(5);
+}
+
+/*!
+    @brief  pulse the reset pin and wait for the controller to start
+*/
+void CST816S::reset()
+{
+    digitalWrite(_rst, LOW);
+    delay(5);
+    digitalWrite(_rst, HIGH);
+    delay(50);
+}
+
+/*!
+    @brief  serialize bus transfers between the reader task and the task calling the driver, which
+            share Wire; without a reader task there is only one of them and nothing is locked
+*/
+void CST816S::lock_bus()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_bus_mutex != nullptr)
+    {
+        xSemaphoreTake(_bus_mutex, portMAX_DELAY);
+    }
+#endif
+}
+
+void CST816S::unlock_bus()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_bus_mutex != nullptr)
+    {
+        xSemaphoreGive(_bus_mutex);
+    }
+#endif
+}
+
+/*!
+    @brief  serialize event queue access between the reading and consuming tasks
+*/
+void CST816S::lock_queue()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    portENTER_CRITICAL(&_queue_mux);
+#else
+    noInterrupts();
+#endif
+}
+
+void CST816S::unlock_queue()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    portEXIT_CRITICAL(&_queue_mux);
+#else
+    interrupts();
+#endif
+}
+
+/*!
+    @brief  increment an error counter shared with the reader task
+*/
+void CST816S::count_error(uint32_t &counter)
+{
+    lock_queue();
+    counter++;
+    unlock_queue();
+}
+
+/*!
+    @brief  add a decoded touch event to the event queue
+*/
+void CST816S::push_event(const touch_event &event, uint8_t classes)
+{
+    lock_queue();
+    _queue.push(event, classes);
+    unlock_queue();
+}
+
+/*!
+    @brief  take the oldest buffered touch event without accessing the bus
+  @param	event
+      filled with the event when one is available
+  @return true if an event was returned
 */
-void CST816S::read_touch()
+bool CST816S::readEvent(touch_event &event)
 {
-    uint8_t data_raw[8];
-    i2c_read(CST816S_ADDRESS, 0x01, data_raw, 6);
+    lock_queue();
+    bool ok = _queue.pop(event);
+    unlock_queue();
+    return ok;
+}
 
-    data.gestureID = rotateGesture(data_raw[0]);
-    data.points = data_raw[1];
-    data.event = data_raw[2] >> 6;
-    data.x = ((data_raw[2] & 0xF) << 8) + data_raw[3];
-    data.y = ((data_raw[4] & 0xF) << 8) + data_raw[5];
-    rotatePoint(data.x, data.y);
+/*!
+    @brief  number of buffered touch events not yet taken with readEvent()
+*/
+uint8_t CST816S::eventsPending()
+{
+    lock_queue();
+    uint8_t size = _queue.size();
+    unlock_queue();
+    return size;
+}
+
+/*!
+    @brief  number of touch events discarded because the event queue was full
+*/
+uint32_t CST816S::eventsDropped()
+{
+    lock_queue();
+    uint32_t dropped = _queue.dropped();
+    unlock_queue();
+    return dropped;
+}
+
+/*!
+    @brief  choose what happens when the event queue is full
+  @param	policy
+      QUEUE_DROP_NEWEST (default), QUEUE_DROP_OLDEST, QUEUE_MERGE_MOVES or QUEUE_KEEP_EDGES
+*/
+void CST816S::setQueuePolicy(uint8_t policy)
+{
+    lock_queue();
+    _queue.setPolicy(policy);
+    unlock_queue();
+}
+
+/*!
+    @brief  overflow counters of the event queue
+*/
+queue_stats CST816S::queueStats()
+{
+    lock_queue();
+    queue_stats stats = _queue.stats();
+    unlock_queue();
+    return stats;
 }
 
 /*!
@@ -132,20 +673,185 @@ void CST816S::read_touch()
 */
 void CST816S::handleISR()
 {
-    _event_available = true;
+    _irq_time = timestamp_us();
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_reader_task != nullptr)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_reader_task, &woken);
+        if (woken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+    else
+#endif
+    {
+        _event_available = true;
+    }
+#ifndef CST816S_NO_USER_ISR
     if (userISR != nullptr)
     {
         userISR();
     }
+#endif
+}
+
+#ifdef CST816S_NO_USER_ISR
+void CST816S::isr_trampoline(void *arg)
+{
+    static_cast<CST816S *>(arg)->handleISR();
+}
+#endif
+
+/*!
+    @brief  Read reports in a task of their own, so the bus transfer of the next report overlaps
+            decoding, filtering and dispatching the previous one in available().
+  @param	priority
+      FreeRTOS priority of the reader task, above the task calling available()
+  @param	core
+      core the reader task is pinned to, -1 for any
+  @return false if the task could not be created or the platform has no FreeRTOS
+*/
+bool CST816S::enablePipeline(uint8_t priority, int core)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_reader_task != nullptr)
+    {
+        return true;
+    }
+    if (_bus_mutex == nullptr)
+    {
+        // the application task keeps calling configuration functions while the reader task transfers
+        _bus_mutex = xSemaphoreCreateMutex();
+        if (_bus_mutex == nullptr)
+        {
+            return false;
+        }
+    }
+    TaskHandle_t task;
+    if (xTaskCreatePinnedToCore(pipeline_task, "cst816s", CST816S_PIPELINE_STACK, this, priority, &task,
+                                core < 0 ? tskNO_AFFINITY : core) != pdPASS)
+    {
+        return false;
+    }
+    _reader_task = task; // from here on the interrupt notifies the task
+    return true;
+#else
+    (void)priority;
+    (void)core;
+    return false;
+#endif
 }
 
+/*!
+    @brief  Stop the reader task started by enablePipeline() and read reports in available() again.
+            Reports the task had read but available() had not processed yet are counted as lost events.
+*/
+void CST816S::disablePipeline()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    lock_queue();
+    TaskHandle_t task = _reader_task;
+    _reader_task = nullptr; // from here on the interrupt sets _event_available and the task stays off the bus
+    unlock_queue();
+    if (task == nullptr)
+    {
+        return;
+    }
+    while (_fetching)
+    {
+        delay(1);
+    }
+    vTaskDelete(task);
+
+    lock_queue();
+    _errors.lostEvents += _frames_ready;
+    _frames_ready = 0;
+    _frame_read = 0;
+    _frame_write = 0;
+    unlock_queue();
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void CST816S::pipeline_task(void *arg)
+{
+    CST816S *touch = static_cast<CST816S *>(arg);
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        touch->pipeline_fetch();
+    }
+}
+
+/*!
+    @brief  transfer one report into a free slot, runs in the reader task
+*/
+void CST816S::pipeline_fetch()
+{
+    lock_queue();
+    if (_reader_task == nullptr)
+    {
+        unlock_queue(); // notified before disablePipeline()
+        return;
+    }
+    if (_frames_ready == 2 || _recovering)
+    {
+        // both slots wait for available(), or the bus is being reset
+        _errors.lostEvents++;
+        unlock_queue();
+        return;
+    }
+    _fetching = true;
+    uint8_t slot = _frame_write;
+    unlock_queue();
+
+    fetch_frame(_frames[slot]);
+
+    lock_queue();
+    _fetching = false;
+    _frame_write = slot ^ 1;
+    _frames_ready++;
+    unlock_queue();
+}
+
+/*!
+    @brief  process the oldest slot filled by the reader task, which meanwhile fills the other
+    @return true if the frame produced an event
+*/
+bool CST816S::process_pipeline()
+{
+    lock_queue();
+    bool ready = _frames_ready > 0;
+    unlock_queue();
+    if (!ready)
+    {
+        return false;
+    }
+
+    bool produced = process_frame(_frames[_frame_read]);
+
+    lock_queue();
+    _frame_read ^= 1;
+    _frames_ready--;
+    unlock_queue();
+    return produced;
+}
+#endif
+
+#ifndef CST816S_NO_CONFIG
 /*!
     @brief  enable double click
 */
 void CST816S::enable_double_click()
 {
-    uint8_t enableDoubleTap = 0x01; // Set EnDClick (bit 0) to enable double-tap
-    i2c_write(CST816S_ADDRESS, 0xEC, &enableDoubleTap, 1);
+    if (!_chip->doubleClick)
+    {
+        return;
+    }
+    _motion_mask = CST816S_EN_DCLICK::set(1).bits;
+    write_motion_mask();
 }
 
 /*!
@@ -153,8 +859,12 @@ void CST816S::enable_double_click()
 */
 void CST816S::disable_auto_sleep()
 {
-    uint8_t disableAutoSleep = 0xFE; // Non-zero value disables auto sleep
-    i2c_write(CST816S_ADDRESS, 0xFE, &disableAutoSleep, 1);
+    if (!_chip->autoSleepConfig)
+    {
+        return;
+    }
+    _dis_auto_sleep = 0xFE; // Non-zero value disables auto sleep
+    write_reg(CST816S_DIS_AUTO_SLEEP::set(_dis_auto_sleep));
 }
 
 /*!
@@ -162,8 +872,12 @@ void CST816S::disable_auto_sleep()
 */
 void CST816S::enable_auto_sleep()
 {
-    uint8_t enableAutoSleep = 0x00; // 0 value enables auto sleep
-    i2c_write(CST816S_ADDRESS, 0xFE, &enableAutoSleep, 1);
+    if (!_chip->autoSleepConfig)
+    {
+        return;
+    }
+    _dis_auto_sleep = 0x00; // 0 value enables auto sleep
+    write_reg(CST816S_DIS_AUTO_SLEEP::set(_dis_auto_sleep));
 }
 
 /*!
@@ -172,6 +886,10 @@ void CST816S::enable_auto_sleep()
 */
 void CST816S::set_auto_sleep_time(int seconds)
 {
+    if (!_chip->autoSleepConfig)
+    {
+        return;
+    }
     if (seconds < 1)
     {
         seconds = 1; // Enforce minimum value of 1 second
@@ -181,9 +899,10 @@ void CST816S::set_auto_sleep_time(int seconds)
         seconds = 255; // Enforce maximum value of 255 seconds
     }
 
-    uint8_t sleepTime = static_cast<uint8_t>(seconds); // Convert int to uint8_t
-    i2c_write(CST816S_ADDRESS, 0xF9, &sleepTime, 1);
+    _auto_sleep_time = seconds;
+    write_reg(CST816S_AUTO_SLEEP_TIME::set(seconds));
 }
+#endif
 
 /*!
     @brief  initialize the touch screen
@@ -192,26 +911,124 @@ void CST816S::set_auto_sleep_time(int seconds)
 */
 void CST816S::begin(int interrupt)
 {
-    // Changed config to make I2C initilization 400kHz
-    _wire.begin(_sda, _scl, 400000);
+    // Start at 400kHz, negotiate_clock() picks the fastest reliable clock once the controller is up
+    _wire.begin(_sda, _scl, i2c_clocks[_clock_index]);
 
     pinMode(_irq, INPUT);
     pinMode(_rst, OUTPUT);
 
     digitalWrite(_rst, HIGH);
     delay(50);
-    digitalWrite(_rst, LOW);
-    delay(5);
-    digitalWrite(_rst, HIGH);
-    delay(50);
+    reset();
 
-    i2c_read(CST816S_ADDRESS, 0x15, &data.version, 1);
-    delay(5);
-    i2c_read(CST816S_ADDRESS, 0xA7, data.versionInfo, 3);
+    negotiate_clock();
+    probe();
 
+#ifndef CST816S_NO_USER_ISR
     attachInterrupt(_irq, std::bind(&CST816S::handleISR, this), interrupt);
+#else
+    attachInterruptArg(_irq, isr_trampoline, this, interrupt);
+#endif
+}
+
+/*!
+    @brief  select the fastest bus clock at which the ID registers read back consistently, up to the
+            fastest clock the identified part is specified for, or the one set by setMaxI2CClock()
+*/
+void CST816S::negotiate_clock()
+{
+    error_stats saved = _errors; // failures while probing are expected, do not report them
+
+    // reference read at the slowest clock
+    uint8_t reference[3];
+    _wire.setClock(i2c_clocks[I2C_CLOCK_COUNT - 1]);
+    _clock_index = I2C_CLOCK_COUNT - 1;
+    if (i2c_read(CST816S_ADDRESS, CST816S_REG_CHIP_ID::address, reference, 3) == 0)
+    {
+        uint32_t limit = cst816s_chip_traits(reference[0]).maxClock;
+        if (limit > _max_clock || _clock_above_chip)
+        {
+            limit = _max_clock;
+        }
+        for (uint8_t i = 0; i < I2C_CLOCK_COUNT - 1; i++)
+        {
+            if (i2c_clocks[i] > limit)
+            {
+                continue;
+            }
+            _wire.setClock(i2c_clocks[i]);
+            bool stable = true;
+            for (int n = 0; n < CST816S_CLOCK_PROBE_READS && stable; n++)
+            {
+                uint8_t check[3];
+                stable = i2c_read(CST816S_ADDRESS, CST816S_REG_CHIP_ID::address, check, 3) == 0 && memcmp(check, reference, 3) == 0;
+            }
+            if (stable)
+            {
+                _clock_index = i;
+                break;
+            }
+        }
+    }
+    _wire.setClock(i2c_clocks[_clock_index]);
+    _errors = saved;
+}
+
+/*!
+    @brief  read the chip, project and firmware IDs and select the chip traits
+*/
+void CST816S::probe()
+{
+    i2c_read(CST816S_ADDRESS, CST816S_REG_VERSION::address, &data.version, 1);
+    delay(5);
+    // ChipID (0xA7), ProjID (0xA8) and FwVersion (0xA9)
+    if (i2c_read(CST816S_ADDRESS, CST816S_REG_CHIP_ID::address, data.versionInfo, 3) == 0)
+    {
+        _chip = &cst816s_chip_traits(data.versionInfo[0]);
+    }
+}
+
+/*!
+    @brief  traits of the controller identified by begin()
+*/
+const chip_traits &CST816S::chip()
+{
+    return *_chip;
+}
+
+/*!
+    @brief  Limit the bus clock tried by begin(), e.g. 100000 for boards with long cables
+  @param	hz
+      fastest clock to try
+  @param	aboveChipLimit
+      true to try hz even where the identified part is specified for less, e.g. 1000000 for
+      boards where Fast-mode Plus is known to work; the negotiation still falls back on errors
+*/
+void CST816S::setMaxI2CClock(uint32_t hz, bool aboveChipLimit)
+{
+    _max_clock = hz;
+    _clock_above_chip = aboveChipLimit;
+}
+
+/*!
+    @brief  Read up to this many touch points, also where the identified part is specified for fewer
+  @param	points
+      at most CST816S_MAX_POINTS, 0 to follow the chip traits again
+*/
+void CST816S::setMaxPoints(uint8_t points)
+{
+    _max_points = points < CST816S_MAX_POINTS ? points : CST816S_MAX_POINTS;
 }
 
+/*!
+    @brief  bus clock in Hz selected by begin() and lowered after repeated bus errors
+*/
+uint32_t CST816S::i2cClock()
+{
+    return i2c_clocks[_clock_index];
+}
+
+#ifndef CST816S_NO_USER_ISR
 /*!
     @brief  Attaches a user-defined callback function to be triggered on an interrupt event from the CST816S touch controller.
     @param  callback  A function to be called when an interrupt event occurs, must have no parameters and return void.
@@ -220,75 +1037,176 @@ void CST816S::attachUserInterrupt(std::function<void()> callback)
 {
     userISR = callback;
 }
+#endif
+
+/*!
+    @brief  Attaches a callback receiving every raw report frame as a trace record, see CST816S_trace.h.
+    @param  callback  Called from the context that reads the touch data, nullptr to detach.
+    @param  arg  Passed unchanged to the callback.
+*/
+void CST816S::attachTraceCallback(trace_callback callback, void *arg)
+{
+    _trace_cb = callback;
+    _trace_arg = arg;
+}
 
 /*!
     @brief  check for a touch event
 */
 bool CST816S::available()
 {
+#if defined(ARDUINO_ARCH_ESP32)
+    if (_reader_task != nullptr)
+    {
+        return process_pipeline();
+    }
+#endif
     if (_event_available)
     {
-        read_touch();
         _event_available = false;
-        return true;
+        return read_touch();
     }
     return false;
 }
 
+/*!
+    @brief  bus and report error counters
+*/
+const error_stats &CST816S::errors()
+{
+    return _errors;
+}
+
 /*!
     @brief  put the touch screen in standby mode
 */
 void CST816S::sleep()
 {
-    digitalWrite(_rst, LOW);
-    delay(5);
-    digitalWrite(_rst, HIGH);
-    delay(50);
-    uint8_t standby_value = 0x03;
-    i2c_write(CST816S_ADDRESS, 0xA5, &standby_value, 1);
+    reset();
+    if (!_chip->standby)
+    {
+        return;
+    }
+    write_reg(CST816S_DEEP_SLEEP::set(0x03));
 }
 
+/*!
+    @brief  Low-power mode for a display that is off: the controller stops reporting coordinates and
+            only raises the interrupt for swipes and, where supported, double clicks, scanning at its
+            low-power rate while untouched. On ESP32 the interrupt pin becomes a wake up source
+            (ext0 where the pin allows it, else GPIO wake up from light sleep).
+    @return false if the controller has no gestures or interrupt control, or its configuration could not be read
+*/
+bool CST816S::enterGestureWake()
+{
+    if (_gesture_wake)
+    {
+        return true;
+    }
+    if (!_chip->gestures || !_chip->irqControl || !_chip->autoSleepConfig)
+    {
+        return false;
+    }
+    if (i2c_read(CST816S_ADDRESS, CST816S_REG_MOTION_MASK::address, _wake_saved, CST816S_CONFIG_BLOCK) != 0)
+    {
+        return false;
+    }
+    if (write_gesture_wake() != 0)
+    {
+        return false;
+    }
+    _gesture_wake = true;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // the interrupt line idles high and is pulsed low for a gesture
+#if defined(SOC_PM_SUPPORT_EXT0_WAKEUP) || defined(SOC_PM_SUPPORT_EXT_WAKEUP)
+    if (esp_sleep_enable_ext0_wakeup((gpio_num_t)_irq, 0) != ESP_OK)
+#endif
+    {
+        gpio_wakeup_enable((gpio_num_t)_irq, GPIO_INTR_LOW_LEVEL);
+        esp_sleep_enable_gpio_wakeup();
+    }
+#endif
+    return true;
+}
+
+/*!
+    @brief  Restore the configuration saved by enterGestureWake() in a single bus transfer. A controller
+            in its low-power scan does not acknowledge it, then it is reset and the write repeated. The
+            ESP32 wake up sources are disabled once the configuration is restored.
+    @return false if the write failed: gesture wake stays active with the saved configuration and wake
+            up sources kept, recoveries keep applying it, and the call can be repeated
+*/
+bool CST816S::exitGestureWake()
+{
+    if (!_gesture_wake)
+    {
+        return true;
+    }
+
+    if (i2c_write(CST816S_ADDRESS, CST816S_REG_MOTION_MASK::address, _wake_saved, CST816S_CONFIG_BLOCK) != 0)
+    {
+        // CST816S_WAKE_SLEEP_TIME after the last touch only a touch or a reset wakes the controller
+        reset();
+        if (i2c_write(CST816S_ADDRESS, CST816S_REG_MOTION_MASK::address, _wake_saved, CST816S_CONFIG_BLOCK) != 0)
+        {
+            // the reset configuration is back in the controller, put gesture wake back for the retry
+            write_gesture_wake();
+            return false;
+        }
+    }
+    _gesture_wake = false;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT0);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    gpio_wakeup_disable((gpio_num_t)_irq);
+#endif
+    return true;
+}
+
+/*!
+    @brief  true between enterGestureWake() and exitGestureWake()
+*/
+bool CST816S::gestureWakeActive()
+{
+    return _gesture_wake;
+}
+
+/*!
+    @brief  write the gesture wake configuration, derived from the saved block, in one burst
+*/
+uint8_t CST816S::write_gesture_wake()
+{
+    const uint8_t base = CST816S_REG_MOTION_MASK::address;
+    uint8_t block[CST816S_CONFIG_BLOCK];
+    memcpy(block, _wake_saved, CST816S_CONFIG_BLOCK);
+
+    // swipes are always detected, double clicks need EnDClick
+    block[CST816S_REG_MOTION_MASK::offset<base>()] = CST816S_EN_DCLICK::set(_chip->doubleClick).bits;
+    // gestures only: no periodic (EnTouch) or touch state (EnChange) reports with coordinates
+    block[CST816S_REG_IRQ_CTL::offset<base>()] = CST816S_EN_MOTION::set(1).bits;
+    block[CST816S_REG_AUTO_SLEEP_TIME::offset<base>()] = CST816S_AUTO_SLEEP_TIME::set(CST816S_WAKE_SLEEP_TIME).bits;
+    block[CST816S_REG_DIS_AUTO_SLEEP::offset<base>()] = CST816S_DIS_AUTO_SLEEP::set(0).bits;
+    return i2c_write(CST816S_ADDRESS, base, block, CST816S_CONFIG_BLOCK);
+}
+
+#ifndef CST816S_NO_GESTURE_NAMES
 /*!
     @brief  get the gesture event name
 */
 String CST816S::gesture()
 {
-    switch (data.gestureID)
-    {
-    case NONE:
-        return "NONE";
-        break;
-    case SWIPE_DOWN:
-        return "SWIPE DOWN";
-        break;
-    case SWIPE_UP:
-        return "SWIPE UP";
-        break;
-    case SWIPE_LEFT:
-        return "SWIPE LEFT";
-        break;
-    case SWIPE_RIGHT:
-        return "SWIPE RIGHT";
-        break;
-    case SINGLE_CLICK:
-        return "SINGLE CLICK";
-        break;
-    case DOUBLE_CLICK:
-        return "DOUBLE CLICK";
-        break;
-    case LONG_PRESS:
-        return "LONG PRESS";
-        break;
-    default:
-        return "UNKNOWN";
-        break;
-    }
+    return cst816s_gesture_name(data.gestureID);
 }
+#endif
 
+#ifndef CST816S_NO_ROTATION
 void CST816S::setRotation(int rotation)
 {
     _rotation = rotation % 4;
 }
+#endif
 
 /*!
     @brief  read data from i2c
@@ -300,18 +1218,35 @@ void CST816S::setRotation(int rotation)
       array to copy the read data
   @param	length
       length of data
+  @return 0, ERROR_NACK or ERROR_SHORT_READ
 */
 uint8_t CST816S::i2c_read(uint16_t addr, uint8_t reg_addr, uint8_t *reg_data, uint32_t length)
 {
+    // the register pointer write and the read must not be split by a transfer of the other task
+    lock_bus();
     _wire.beginTransmission(addr);
     _wire.write(reg_addr);
     if (_wire.endTransmission(true))
-        return -1;
-    _wire.requestFrom(addr, length, true);
-    for (int i = 0; i < length; i++)
+    {
+        unlock_bus();
+        count_error(_errors.nack);
+        return ERROR_NACK;
+    }
+    if (_wire.requestFrom(addr, length, true) != length)
+    {
+        while (_wire.available())
+        {
+            _wire.read(); // discard the partial report
+        }
+        unlock_bus();
+        count_error(_errors.shortRead);
+        return ERROR_SHORT_READ;
+    }
+    for (uint32_t i = 0; i < length; i++)
     {
         *reg_data++ = _wire.read();
     }
+    unlock_bus();
     return 0;
 }
 
@@ -326,16 +1261,23 @@ uint8_t CST816S::i2c_read(uint16_t addr, uint8_t reg_addr, uint8_t *reg_data, ui
       data to be sent
   @param	length
       length of data
+  @return 0 or ERROR_NACK
 */
 uint8_t CST816S::i2c_write(uint8_t addr, uint8_t reg_addr, const uint8_t *reg_data, uint32_t length)
 {
+    lock_bus();
     _wire.beginTransmission(addr);
     _wire.write(reg_addr);
-    for (int i = 0; i < length; i++)
+    for (uint32_t i = 0; i < length; i++)
     {
         _wire.write(*reg_data++);
     }
-    if (_wire.endTransmission(true))
-        return -1;
+    uint8_t status = _wire.endTransmission(true);
+    unlock_bus();
+    if (status)
+    {
+        count_error(_errors.nack);
+        return ERROR_NACK;
+    }
     return 0;
 }
\ No newline at end of file
@@ -28,19 +28,61 @@
 #include <Arduino.h>
 #include <Wire.h> // Include the Wire library
 
+#include "CST816S_decode.h"
+#include "CST816S_trace.h"
+#include "CST816S_chips.h"
+#include "CST816S_queue.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
 #define CST816S_ADDRESS 0x15
 
-enum GESTURE
-{
-    NONE = 0x00,
-    SWIPE_UP = 0x01,
-    SWIPE_DOWN = 0x02,
-    SWIPE_LEFT = 0x03,
-    SWIPE_RIGHT = 0x04,
-    SINGLE_CLICK = 0x05,
-    DOUBLE_CLICK = 0x0B,
-    LONG_PRESS = 0x0C
-};
+/*
+    Optional features, define as build flags only (e.g. build_flags in platformio.ini) to strip them.
+    Defining them in a sketch before the include changes class CST816S for the sketch but not for
+    CST816S.cpp, which is compiled separately, and the two then disagree on the object layout.
+
+    CST816S_NO_USER_ISR       attachUserInterrupt() and the std::function / FunctionalInterrupt it needs
+    CST816S_NO_GESTURE_NAMES  gesture() and its String names
+    CST816S_NO_ROTATION       setRotation() and setSize(), coordinates are reported as the panel sends them
+    CST816S_NO_CONFIG         double click and auto sleep configuration
+    CST816S_MINIMAL           all of the above
+*/
+#ifdef CST816S_MINIMAL
+#define CST816S_NO_USER_ISR
+#define CST816S_NO_GESTURE_NAMES
+#define CST816S_NO_ROTATION
+#define CST816S_NO_CONFIG
+#endif
+
+// Maximum number of event sinks attached with addSink()
+#ifndef CST816S_MAX_SINKS
+#define CST816S_MAX_SINKS 4
+#endif
+
+// Touch points decoded per report, controllers reporting more fingers are truncated
+#ifndef CST816S_MAX_POINTS
+#define CST816S_MAX_POINTS 2
+#endif
+
+// Number of identical register reads required before a bus clock is accepted
+#ifndef CST816S_CLOCK_PROBE_READS
+#define CST816S_CLOCK_PROBE_READS 16
+#endif
+
+// Consecutive failed reads after which the controller and bus are reset
+#ifndef CST816S_MAX_READ_ERRORS
+#define CST816S_MAX_READ_ERRORS 3
+#endif
+
+// Stack size of the reader task started by enablePipeline()
+#ifndef CST816S_PIPELINE_STACK
+#define CST816S_PIPELINE_STACK 3072
+#endif
 
 struct data_struct
 {
@@ -50,9 +92,43 @@ struct data_struct
     int x;
     int y;
     uint8_t version;
-    uint8_t versionInfo[3];
+    uint8_t versionInfo[3]; // Chip ID, project ID, firmware version
+    uint8_t touchCount;     // Number of valid entries in touches, at least 1 for the primary point
+    touch_point touches[CST816S_MAX_POINTS];
+};
+
+struct error_stats
+{
+    uint32_t nack;          // Transfers not acknowledged by the controller
+    uint32_t shortRead;     // Reads returning fewer bytes than requested
+    uint32_t invalidFrame;  // Reports with impossible contents (spurious interrupt, chip reset)
+    uint32_t lostEvents;    // Interrupts that did not produce an event
+    uint32_t recoveries;    // Controller and bus resets after repeated errors
+    uint32_t recoveryTime;  // Duration of the last recovery in ms
+};
+
+// Seconds without touch before the controller drops to its low-power scan in gesture wake mode
+#ifndef CST816S_WAKE_SLEEP_TIME
+#define CST816S_WAKE_SLEEP_TIME 1
+#endif
+
+// Configuration registers MotionMask (0xEC) to DisAutoSleep (0xFE), saved and restored as one burst
+#define CST816S_CONFIG_BLOCK (CST816S_REG_DIS_AUTO_SLEEP::offset<CST816S_REG_MOTION_MASK::address>() + 1)
+
+// Registers of one report as transferred from the controller, before decoding
+struct raw_frame
+{
+    uint8_t report[6];      // GestureID to YposL of the first point
+#if CST816S_MAX_POINTS > 1
+    uint8_t extra[6 * (CST816S_MAX_POINTS - 1)]; // further points from 0x09
+    uint8_t extraPoints;    // points read into extra
+#endif
+    uint8_t error;          // TOUCH_ERROR of the transfer, 0 if the report was read
+    uint32_t timestamp;     // interrupt time in us
 };
 
+typedef void (*trace_callback)(const trace_record &record, void *arg);
+
 class CST816S
 {
     public:
@@ -60,37 +136,150 @@ class CST816S
         CST816S(int sda, int scl, int rst, int irq, int rotation, TwoWire &wire = Wire);
         CST816S(int sda, int scl, int rst, int irq, TwoWire &wire = Wire);
         void begin(int interrupt = RISING);
+#ifndef CST816S_NO_CONFIG
         void enable_double_click();
         void disable_auto_sleep();
         void enable_auto_sleep();
         void set_auto_sleep_time(int seconds);
+#endif
+#ifndef CST816S_NO_USER_ISR
         void attachUserInterrupt(std::function<void()> callback);
+#endif
+        void attachTraceCallback(trace_callback callback, void *arg = nullptr);
         void sleep();
+        bool enterGestureWake();
+        bool exitGestureWake();
+        bool gestureWakeActive();
         bool available();
         data_struct data;
+#ifndef CST816S_NO_GESTURE_NAMES
         String gesture();
+#endif
+        bool readEvent(touch_event &event);
+        uint8_t eventsPending();
+        uint32_t eventsDropped();
+        void setQueuePolicy(uint8_t policy);
+        queue_stats queueStats();
+        const error_stats &errors();
+        const chip_traits &chip();
+        bool addSink(CST816S_Sink *sink, uint8_t mask = CST816S_EVENT_ALL);
+        void setEventMask(uint8_t mask);
+        uint32_t sinkWakeups();
+        uint32_t sinkWakeupsFiltered();
+        void removeSink(CST816S_Sink *sink);
 
+        void setMaxI2CClock(uint32_t hz, bool aboveChipLimit = false);
+        uint32_t i2cClock();
+        void setMaxPoints(uint8_t points);
+        bool enablePipeline(uint8_t priority = 2, int core = -1);
+        void disablePipeline();
+
+        bool inject(const uint8_t *frame, uint32_t timestamp);
+        bool inject(const touch_event &event);
+
+#ifndef CST816S_NO_ROTATION
         void setRotation(int rotation);
         void setSize(int w, int h);
+#endif
 
     private:
         int _sda;
         int _scl;
         int _rst;
         int _irq;
+#ifndef CST816S_NO_ROTATION
         int _width = 170;
         int _height = 320;
-        bool _event_available;
         int _rotation;
+#endif
+        bool _event_available;
+        volatile uint32_t _irq_time = 0;
+        uint32_t _max_clock = 1000000;
+        bool _clock_above_chip = false;
+        uint8_t _max_points = 0; // 0: as specified for the identified part
+        uint8_t _clock_index = 1; // into the clock table, 400 kHz until negotiated
         TwoWire &_wire; // Add a reference to a TwoWire object
+#ifndef CST816S_NO_USER_ISR
         std::function<void()> userISR;
+#endif
+        CST816S_EventQueue _queue;
+#if defined(ARDUINO_ARCH_ESP32)
+        portMUX_TYPE _queue_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+        error_stats _errors = {};
+        const chip_traits *_chip = &cst816s_chip_traits(0xB4);
+        CST816S_Sink *_sinks[CST816S_MAX_SINKS] = {};
+        uint8_t _sink_masks[CST816S_MAX_SINKS] = {};
+        uint8_t _event_mask = CST816S_EVENT_ALL;
+        uint8_t _last_gesture = NONE;
+        uint32_t _sink_wakeups = 0;
+        uint32_t _sink_wakeups_filtered = 0;
+        trace_callback _trace_cb = nullptr;
+        void *_trace_arg = nullptr;
+        uint8_t _read_errors = 0;
+        uint8_t _read_bus_errors = 0; // NACKs and short reads among _read_errors
+#ifndef CST816S_NO_CONFIG
+        int16_t _motion_mask = -1;      // last values written by the configuration API,
+        int16_t _dis_auto_sleep = -1;   // replayed after a recovery (-1 = never written)
+        int16_t _auto_sleep_time = -1;
+#endif
+        int16_t _irq_ctl = -1;
+        bool _gesture_wake = false;
+        uint8_t _wake_saved[CST816S_CONFIG_BLOCK]; // configuration before enterGestureWake()
+#if defined(ARDUINO_ARCH_ESP32)
+        TaskHandle_t _reader_task = nullptr;
+        raw_frame _frames[2];       // filled by the reader task, processed by available()
+        uint8_t _frame_read = 0;
+        uint8_t _frame_write = 0;
+        uint8_t _frames_ready = 0;
+        volatile bool _fetching = false; // reader task is using the bus
+        bool _recovering = false;        // reader task must stay off the bus
+        SemaphoreHandle_t _bus_mutex = nullptr; // one transfer at a time once there is a reader task
+#endif
+
+        void push_event(const touch_event &event, uint8_t classes);
+        void count_error(uint32_t &counter);
+        void lock_queue();
+        void unlock_queue();
+        void dispatch(const touch_event &event, uint8_t classes);
+        void dispatch_error(uint8_t error, uint32_t timestamp);
+        uint8_t read_points(const raw_frame &frame);
 
         uint8_t rotateGesture(uint8_t gestureID);
         void rotatePoint(int &x, int &y);
         void IRAM_ATTR handleISR();
-        void read_touch();
+#ifdef CST816S_NO_USER_ISR
+        static void IRAM_ATTR isr_trampoline(void *arg);
+#endif
+        bool read_touch();
+        void fetch_frame(raw_frame &frame);
+        bool process_frame(raw_frame &frame, bool injected = false);
+        bool publish(const touch_event &event);
+#if defined(ARDUINO_ARCH_ESP32)
+        bool process_pipeline();
+        void pipeline_fetch();
+        static void pipeline_task(void *arg);
+#endif
+        void read_failed(uint8_t error, uint32_t timestamp);
+        void reset();
+        void probe();
+        uint8_t write_gesture_wake();
+#ifndef CST816S_NO_CONFIG
+        void write_motion_mask();
+#endif
+        void negotiate_clock();
+        void recover();
+        void bus_clear();
+        void lock_bus();
+        void unlock_bus();
         uint8_t i2c_read(uint16_t addr, uint8_t reg_addr, uint8_t *reg_data, uint32_t length);
         uint8_t i2c_write(uint8_t addr, uint8_t reg_addr, const uint8_t *reg_data, uint32_t length);
+
+        template <typename Reg>
+        uint8_t write_reg(cst816s_value<Reg> value)
+        {
+            return i2c_write(CST816S_ADDRESS, Reg::address, &value.bits, 1);
+        }
 };
 
 #endif
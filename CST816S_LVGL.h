@@ -0,0 +1,115 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_LVGL_H
+#define CST816S_LVGL_H
+
+#include <lvgl.h>
+#include "CST816S.h"
+
+/*
+    LVGL pointer input device fed from the CST816S event queue.
+
+    The read callback only drains events that CST816S::available() already
+    decoded, so LVGL's timer handler never touches the I2C bus. Events that do
+    not change the pressed state or the point are skipped, and when more
+    events are queued LVGL is asked to read again in the same cycle so no
+    intermediate points are lost.
+*/
+class CST816S_LVGL
+{
+    public:
+        CST816S_LVGL(CST816S &touch) : _touch(touch) {}
+
+        /*!
+            @brief  register the touch screen as an LVGL pointer device
+            @return the created input device
+        */
+        lv_indev_t *begin()
+        {
+#if LVGL_VERSION_MAJOR >= 9
+            _indev = lv_indev_create();
+            lv_indev_set_type(_indev, LV_INDEV_TYPE_POINTER);
+            lv_indev_set_read_cb(_indev, read_cb);
+            lv_indev_set_user_data(_indev, this);
+#else
+            lv_indev_drv_init(&_drv);
+            _drv.type = LV_INDEV_TYPE_POINTER;
+            _drv.read_cb = read_cb;
+            _drv.user_data = this;
+            _indev = lv_indev_drv_register(&_drv);
+#endif
+            return _indev;
+        }
+
+        lv_indev_t *indev() { return _indev; }
+
+    private:
+        CST816S &_touch;
+        lv_indev_t *_indev = nullptr;
+#if LVGL_VERSION_MAJOR < 9
+        lv_indev_drv_t _drv;
+#endif
+        bool _pressed = false;
+        lv_coord_t _x = 0;
+        lv_coord_t _y = 0;
+
+#if LVGL_VERSION_MAJOR >= 9
+        static void read_cb(lv_indev_t *indev, lv_indev_data_t *data)
+        {
+            static_cast<CST816S_LVGL *>(lv_indev_get_user_data(indev))->read(data);
+        }
+#else
+        static void read_cb(lv_indev_drv_t *drv, lv_indev_data_t *data)
+        {
+            static_cast<CST816S_LVGL *>(drv->user_data)->read(data);
+        }
+#endif
+
+        void read(lv_indev_data_t *data)
+        {
+            touch_event event;
+            while (_touch.readEvent(event))
+            {
+                bool pressed = event.event != 1; // Down and Contact keep the pointer pressed
+                if (pressed == _pressed && (!pressed || (event.x == _x && event.y == _y)))
+                {
+                    continue; // no change for LVGL
+                }
+                _pressed = pressed;
+                if (pressed)
+                {
+                    _x = event.x;
+                    _y = event.y;
+                }
+                data->continue_reading = _touch.eventsPending() > 0;
+                break;
+            }
+            data->point.x = _x;
+            data->point.y = _y;
+            data->state = _pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+        }
+};
+
+#endif
@@ -0,0 +1,199 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "CST816S_analytics.h"
+
+#define SNAPSHOT_MAGIC 0xA5
+#define SNAPSHOT_VERSION 2
+
+template <typename T>
+static inline void saturating_inc(T &counter)
+{
+    if (counter != (T)~(T)0)
+    {
+        counter++;
+    }
+}
+
+/*!
+    @brief  Constructor for CST816S_Analytics
+  @param	width
+      screen width after rotation
+  @param	height
+      screen height after rotation
+*/
+CST816S_Analytics::CST816S_Analytics(int width, int height)
+{
+    _width = width > 0 ? width : 1;
+    _height = height > 0 ? height : 1;
+    reset();
+}
+
+/*!
+    @brief  counter slot of a gesture, -1 for NONE and unknown IDs
+*/
+int CST816S_Analytics::gesture_slot(uint8_t gestureID)
+{
+    if (gestureID >= SWIPE_UP && gestureID <= SINGLE_CLICK)
+    {
+        return gestureID - SWIPE_UP;
+    }
+    if (gestureID == DOUBLE_CLICK || gestureID == LONG_PRESS)
+    {
+        return gestureID - DOUBLE_CLICK + SINGLE_CLICK;
+    }
+    return -1;
+}
+
+/*!
+    @brief  number of times a gesture was reported
+  @param	gestureID
+      GESTURE value, 0 for NONE and unknown IDs
+*/
+uint32_t CST816S_Analytics::gestures(uint8_t gestureID) const
+{
+    int slot = gesture_slot(gestureID);
+    return slot < 0 ? 0 : _gestures[slot];
+}
+
+/*!
+    @brief  clear all counters
+*/
+void CST816S_Analytics::reset()
+{
+    memset(_heatmap, 0, sizeof(_heatmap));
+    memset(_gestures, 0, sizeof(_gestures));
+    memset(_dwell, 0, sizeof(_dwell));
+    _touches = 0;
+    _down_time = 0;
+    _down = false;
+    _last_gesture = NONE;
+}
+
+/*!
+    @brief  account for a decoded touch event
+*/
+void CST816S_Analytics::onTouchEvent(const touch_event &event)
+{
+    // the gesture register holds its value over several reports, count changes only
+    int slot = gesture_slot(event.gestureID);
+    if (event.gestureID != _last_gesture && slot >= 0)
+    {
+        saturating_inc(_gestures[slot]);
+    }
+    _last_gesture = event.gestureID;
+
+    if (event.event == 1)
+    {
+        if (_down)
+        {
+            uint32_t ms = (event.timestamp - _down_time) / 1000;
+            int bucket = 0;
+            while (ms != 0 && bucket < CST816S_DWELL_BUCKETS - 1)
+            {
+                ms >>= 1;
+                bucket++;
+            }
+            saturating_inc(_dwell[bucket]);
+        }
+        _down = false;
+        return;
+    }
+
+    if (event.event == 0 || !_down)
+    {
+        _down = true;
+        _down_time = event.timestamp;
+        saturating_inc(_touches);
+    }
+
+    int col = event.x * CST816S_HEATMAP_COLS / _width;
+    int row = event.y * CST816S_HEATMAP_ROWS / _height;
+    if (col >= 0 && col < CST816S_HEATMAP_COLS && row >= 0 && row < CST816S_HEATMAP_ROWS)
+    {
+        saturating_inc(_heatmap[row][col]);
+    }
+}
+
+/*!
+    @brief  number of bytes written by snapshot()
+*/
+size_t CST816S_Analytics::snapshotSize() const
+{
+    return 4 + 4 + sizeof(_gestures) + sizeof(_dwell) + sizeof(_heatmap);
+}
+
+/*!
+    @brief  serialize the counters, little-endian
+  @param	buffer
+      destination of at least snapshotSize() bytes
+  @param	size
+      size of buffer
+  @return bytes written, 0 if the buffer is too small
+
+    Layout: magic, version, heatmap columns, heatmap rows, touches (u32),
+    gesture counters (u32: SWIPE_UP, SWIPE_DOWN, SWIPE_LEFT, SWIPE_RIGHT,
+    SINGLE_CLICK, DOUBLE_CLICK, LONG_PRESS), dwell buckets (u16),
+    heatmap cells row by row (u16).
+*/
+size_t CST816S_Analytics::snapshot(uint8_t *buffer, size_t size) const
+{
+    if (size < snapshotSize())
+    {
+        return 0;
+    }
+
+    uint8_t *p = buffer;
+    *p++ = SNAPSHOT_MAGIC;
+    *p++ = SNAPSHOT_VERSION;
+    *p++ = CST816S_HEATMAP_COLS;
+    *p++ = CST816S_HEATMAP_ROWS;
+    for (int i = 0; i < 4; i++)
+    {
+        *p++ = _touches >> (8 * i);
+    }
+    for (int g = 0; g < CST816S_GESTURE_SLOTS; g++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            *p++ = _gestures[g] >> (8 * i);
+        }
+    }
+    for (int b = 0; b < CST816S_DWELL_BUCKETS; b++)
+    {
+        *p++ = _dwell[b];
+        *p++ = _dwell[b] >> 8;
+    }
+    for (int row = 0; row < CST816S_HEATMAP_ROWS; row++)
+    {
+        for (int col = 0; col < CST816S_HEATMAP_COLS; col++)
+        {
+            *p++ = _heatmap[row][col];
+            *p++ = _heatmap[row][col] >> 8;
+        }
+    }
+    return p - buffer;
+}
@@ -0,0 +1,81 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_ANALYTICS_H
+#define CST816S_ANALYTICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+// Heatmap resolution, each cell counts the touch samples in its part of the screen
+#ifndef CST816S_HEATMAP_COLS
+#define CST816S_HEATMAP_COLS 8
+#endif
+#ifndef CST816S_HEATMAP_ROWS
+#define CST816S_HEATMAP_ROWS 8
+#endif
+
+// Dwell histogram buckets, bucket n counts touches held for 2^(n-1) to 2^n ms
+#define CST816S_DWELL_BUCKETS 16
+
+// One gesture counter per known gesture: SWIPE_UP..SINGLE_CLICK, DOUBLE_CLICK, LONG_PRESS
+#define CST816S_GESTURE_SLOTS 7
+
+/*
+    Usage statistics accumulated from decoded touch events with fixed memory
+    and constant work per event. All counters saturate instead of wrapping.
+*/
+class CST816S_Analytics : public CST816S_Sink
+{
+    public:
+        CST816S_Analytics(int width, int height);
+
+        void onTouchEvent(const touch_event &event) override;
+        void reset();
+
+        uint16_t heatmap(int col, int row) const { return _heatmap[row][col]; }
+        uint32_t gestures(uint8_t gestureID) const;
+        uint16_t dwell(int bucket) const { return _dwell[bucket]; }
+        uint32_t touches() const { return _touches; }
+
+        size_t snapshotSize() const;
+        size_t snapshot(uint8_t *buffer, size_t size) const;
+
+    private:
+        static int gesture_slot(uint8_t gestureID);
+
+        int _width;
+        int _height;
+        uint16_t _heatmap[CST816S_HEATMAP_ROWS][CST816S_HEATMAP_COLS];
+        uint32_t _gestures[CST816S_GESTURE_SLOTS];
+        uint16_t _dwell[CST816S_DWELL_BUCKETS];
+        uint32_t _touches;
+        uint32_t _down_time;
+        bool _down;
+        uint8_t _last_gesture;
+};
+
+#endif
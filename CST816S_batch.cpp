@@ -0,0 +1,228 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "CST816S_batch.h"
+#include "CST816S_decode.h"
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+// gesture lookup for swipes 1-4 indexed by gestureID - 1, per rotation 1-3
+static const uint8_t rotated_swipe[3][4] = {
+    {0x03, 0x04, 0x02, 0x01},
+    {0x02, 0x01, 0x04, 0x03},
+    {0x04, 0x03, 0x01, 0x02}};
+
+/*!
+    @brief  reference decode of frames [begin, end)
+*/
+static void decode_scalar(const uint8_t *frames, size_t begin, size_t end, int rotation, int width, int height, const batch_events &out)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        touch_event event;
+        cst816s_decode(frames + i * 6, event);
+        cst816s_rotate_point(event.x, event.y, rotation, width, height);
+        out.gestureID[i] = cst816s_rotate_gesture(event.gestureID, rotation);
+        out.points[i] = event.points;
+        out.event[i] = event.event;
+        out.x[i] = event.x;
+        out.y[i] = event.y;
+    }
+}
+
+#if defined(__SSSE3__)
+
+/*!
+    @brief  decode 8 frames per iteration, returns the number of frames decoded
+*/
+static size_t decode_ssse3(const uint8_t *frames, size_t count, int rotation, int width, int height, const batch_events &out)
+{
+    // per 16 byte load of two frames: XL:XH, YL:YH of both as 16 bit lanes, then gesture, points and XH bytes
+    const __m128i gather = _mm_setr_epi8(3, 2, 5, 4, 9, 8, 11, 10, 0, 6, 1, 7, 2, 8, -1, -1);
+    const __m128i split_xy = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    const __m128i split_meta = _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, -1, -1, -1, -1);
+    const __m128i coord_mask = _mm_set1_epi16(0x0FFF);
+    const __m128i event_mask = _mm_set1_epi8(0x03);
+    const __m128i w1 = _mm_set1_epi16((int16_t)(width - 1));
+    const __m128i h1 = _mm_set1_epi16((int16_t)(height - 1));
+    const bool rotate = rotation >= 1 && rotation <= 3;
+    const __m128i swipe_lut = rotate ? _mm_setr_epi8(rotated_swipe[rotation - 1][0], rotated_swipe[rotation - 1][1],
+                                                     rotated_swipe[rotation - 1][2], rotated_swipe[rotation - 1][3],
+                                                     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+                                     : _mm_setzero_si128();
+
+    size_t i = 0;
+    // the last load reads 4 bytes past the 8th frame, keep one more frame in the buffer
+    for (; i + 9 <= count; i += 8)
+    {
+        const uint8_t *p = frames + i * 6;
+        __m128i r0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), gather);
+        __m128i r1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 12)), gather);
+        __m128i r2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 24)), gather);
+        __m128i r3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 36)), gather);
+
+        __m128i a = _mm_shuffle_epi8(_mm_and_si128(_mm_unpacklo_epi64(r0, r1), coord_mask), split_xy);
+        __m128i b = _mm_shuffle_epi8(_mm_and_si128(_mm_unpacklo_epi64(r2, r3), coord_mask), split_xy);
+        __m128i x = _mm_unpacklo_epi64(a, b);
+        __m128i y = _mm_unpackhi_epi64(a, b);
+        __m128i rx, ry;
+        switch (rotation)
+        {
+        case 1:
+            rx = y;
+            ry = _mm_sub_epi16(w1, x);
+            break;
+        case 2:
+            rx = _mm_sub_epi16(w1, x);
+            ry = _mm_sub_epi16(h1, y);
+            break;
+        case 3:
+            rx = _mm_sub_epi16(h1, y);
+            ry = x;
+            break;
+        default:
+            rx = x;
+            ry = y;
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(out.x + i), rx);
+        _mm_storeu_si128((__m128i *)(out.y + i), ry);
+
+        a = _mm_shuffle_epi8(_mm_unpackhi_epi64(r0, r1), split_meta);
+        b = _mm_shuffle_epi8(_mm_unpackhi_epi64(r2, r3), split_meta);
+        __m128i gp = _mm_unpacklo_epi32(a, b); // gestures 0-7, points 0-7
+        __m128i xh = _mm_unpackhi_epi32(a, b); // XH 0-7
+        __m128i gesture = gp;
+        if (rotate)
+        {
+            __m128i t = _mm_sub_epi8(gesture, _mm_set1_epi8(1));
+            __m128i swipe = _mm_cmpeq_epi8(_mm_min_epu8(t, event_mask), t); // gestureID 1-4
+            __m128i mapped = _mm_shuffle_epi8(swipe_lut, _mm_and_si128(t, event_mask));
+            gesture = _mm_or_si128(_mm_and_si128(swipe, mapped), _mm_andnot_si128(swipe, gesture));
+        }
+        _mm_storel_epi64((__m128i *)(out.gestureID + i), gesture);
+        _mm_storel_epi64((__m128i *)(out.points + i), _mm_srli_si128(gp, 8));
+        _mm_storel_epi64((__m128i *)(out.event + i), _mm_and_si128(_mm_srli_epi16(xh, 6), event_mask));
+    }
+    return i;
+}
+
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+/*!
+    @brief  decode 8 frames per iteration, returns the number of frames decoded
+*/
+static size_t decode_neon(const uint8_t *frames, size_t count, int rotation, int width, int height, const batch_events &out)
+{
+    const int16x8_t w1 = vdupq_n_s16((int16_t)(width - 1));
+    const int16x8_t h1 = vdupq_n_s16((int16_t)(height - 1));
+    const bool rotate = rotation >= 1 && rotation <= 3;
+    uint8_t lut_bytes[8] = {0};
+    if (rotate)
+    {
+        for (int k = 0; k < 4; k++)
+            lut_bytes[k] = rotated_swipe[rotation - 1][k];
+    }
+    const uint8x8_t swipe_lut = vld1_u8(lut_bytes);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // stride 3 deinterleave of 8 frames: {b0, b3}, {b1, b4}, {b2, b5} pairs per frame
+        uint8x16x3_t v = vld3q_u8(frames + i * 6);
+        uint8x16x2_t u0 = vuzpq_u8(v.val[0], v.val[0]);
+        uint8x16x2_t u1 = vuzpq_u8(v.val[1], v.val[1]);
+        uint8x16x2_t u2 = vuzpq_u8(v.val[2], v.val[2]);
+        uint8x8_t gesture = vget_low_u8(u0.val[0]);
+        uint8x8_t xl = vget_low_u8(u0.val[1]);
+        uint8x8_t points = vget_low_u8(u1.val[0]);
+        uint8x8_t yh = vget_low_u8(u1.val[1]);
+        uint8x8_t xh = vget_low_u8(u2.val[0]);
+        uint8x8_t yl = vget_low_u8(u2.val[1]);
+
+        int16x8_t x = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vand_u8(xh, vdup_n_u8(0x0F))), 8), vmovl_u8(xl)));
+        int16x8_t y = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vand_u8(yh, vdup_n_u8(0x0F))), 8), vmovl_u8(yl)));
+        int16x8_t rx, ry;
+        switch (rotation)
+        {
+        case 1:
+            rx = y;
+            ry = vsubq_s16(w1, x);
+            break;
+        case 2:
+            rx = vsubq_s16(w1, x);
+            ry = vsubq_s16(h1, y);
+            break;
+        case 3:
+            rx = vsubq_s16(h1, y);
+            ry = x;
+            break;
+        default:
+            rx = x;
+            ry = y;
+            break;
+        }
+        vst1q_s16(out.x + i, rx);
+        vst1q_s16(out.y + i, ry);
+
+        if (rotate)
+        {
+            uint8x8_t t = vsub_u8(gesture, vdup_n_u8(1));
+            uint8x8_t swipe = vcle_u8(t, vdup_n_u8(3)); // gestureID 1-4
+            gesture = vbsl_u8(swipe, vtbl1_u8(swipe_lut, t), gesture);
+        }
+        vst1_u8(out.gestureID + i, gesture);
+        vst1_u8(out.points + i, points);
+        vst1_u8(out.event + i, vshr_n_u8(xh, 6));
+    }
+    return i;
+}
+
+#endif
+
+void cst816s_decode_batch(const uint8_t *frames, size_t count, int rotation, int width, int height, const batch_events &out)
+{
+    size_t done = 0;
+#if defined(__SSSE3__)
+    done = decode_ssse3(frames, count, rotation, width, height, out);
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    done = decode_neon(frames, count, rotation, width, height, out);
+#endif
+    decode_scalar(frames, done, count, rotation, width, height, out);
+}
+
+const char *cst816s_decode_batch_impl()
+{
+#if defined(__SSSE3__)
+    return "ssse3";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,69 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_BATCH_H
+#define CST816S_BATCH_H
+
+// Batch decoding of raw report frames, kept free of Arduino dependencies
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    Structure-of-arrays output of cst816s_decode_batch(), every array must
+    hold at least `count` entries.
+*/
+struct batch_events
+{
+    uint8_t *gestureID;
+    uint8_t *points;
+    uint8_t *event;
+    int16_t *x;
+    int16_t *y;
+};
+
+/*!
+    @brief  decode and rotate an array of 6 byte report frames
+  @param	frames
+      count * 6 bytes as read from register 0x01, no alignment required
+  @param	count
+      number of frames
+  @param	rotation
+      screen rotation (0-3) as passed to CST816S::setRotation()
+  @param	width
+      panel width as passed to CST816S::setSize()
+  @param	height
+      panel height as passed to CST816S::setSize()
+  @param	out
+      decoded fields, identical to cst816s_decode() followed by
+      cst816s_rotate_gesture() and cst816s_rotate_point()
+*/
+void cst816s_decode_batch(const uint8_t *frames, size_t count, int rotation, int width, int height, const batch_events &out);
+
+/*!
+    @brief  name of the vector implementation selected at build time
+*/
+const char *cst816s_decode_batch_impl();
+
+#endif
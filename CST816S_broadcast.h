@@ -0,0 +1,140 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_BROADCAST_H
+#define CST816S_BROADCAST_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+// Events kept for subscribers, must be a power of two
+#ifndef CST816S_BROADCAST_SIZE
+#define CST816S_BROADCAST_SIZE 16
+#endif
+
+/*
+    Single producer, multi consumer broadcast ring of touch events. The
+    producer never waits: every subscriber keeps its own cursor, and one that
+    falls more than CST816S_BROADCAST_SIZE events behind skips ahead to the
+    oldest event still stored and has the skipped events counted as lost.
+    No locks are taken; each slot carries its sequence number so a reader
+    can tell when the producer overwrote it during the copy.
+*/
+class CST816S_Broadcast : public CST816S_Sink
+{
+    public:
+        class Subscriber
+        {
+            public:
+                Subscriber(CST816S_Broadcast &bus) : _bus(bus), _cursor(bus.published()) {}
+
+                bool read(touch_event &event) { return _bus.read(*this, event); }
+                uint32_t pending() const { return _bus.published() - _cursor; }
+                uint32_t lost() const { return _lost; }
+                uint32_t lagged() const { return _lagged; }
+
+            private:
+                friend class CST816S_Broadcast;
+                CST816S_Broadcast &_bus;
+                uint32_t _cursor;
+                uint32_t _lost = 0;   // events overwritten before they were read
+                uint32_t _lagged = 0; // times the subscriber had to skip ahead
+        };
+
+        void onTouchEvent(const touch_event &event) override { publish(event); }
+
+        /*!
+            @brief  publish an event to all subscribers, only one thread may publish
+        */
+        void publish(const touch_event &event)
+        {
+            uint32_t seq = _published.load(std::memory_order_relaxed);
+            Slot &slot = _slots[seq & (CST816S_BROADCAST_SIZE - 1)];
+            // odd sequence marks the slot as being written
+            slot.seq.store(2 * seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.event = event;
+            slot.seq.store(2 * seq + 2, std::memory_order_release);
+            _published.store(seq + 1, std::memory_order_release);
+        }
+
+        uint32_t published() const { return _published.load(std::memory_order_acquire); }
+
+    private:
+        static_assert((CST816S_BROADCAST_SIZE & (CST816S_BROADCAST_SIZE - 1)) == 0,
+                      "CST816S_BROADCAST_SIZE must be a power of two");
+
+        struct Slot
+        {
+            std::atomic<uint32_t> seq{0};
+            touch_event event;
+        };
+
+        Slot _slots[CST816S_BROADCAST_SIZE];
+        std::atomic<uint32_t> _published{0};
+
+        bool read(Subscriber &sub, touch_event &event)
+        {
+            for (;;)
+            {
+                uint32_t head = published();
+                if (sub._cursor == head)
+                {
+                    return false;
+                }
+                if (head - sub._cursor > CST816S_BROADCAST_SIZE)
+                {
+                    uint32_t oldest = head - CST816S_BROADCAST_SIZE;
+                    sub._lost += oldest - sub._cursor;
+                    sub._lagged++;
+                    sub._cursor = oldest;
+                }
+
+                const Slot &slot = _slots[sub._cursor & (CST816S_BROADCAST_SIZE - 1)];
+                uint32_t expected = 2 * sub._cursor + 2;
+                // Being or having been overwritten since head was read: the event is gone, count it
+                // and move on rather than wait, as the producer may not run until this reader yields
+                if (slot.seq.load(std::memory_order_acquire) != expected)
+                {
+                    sub._lost++;
+                    sub._cursor++;
+                    continue;
+                }
+                event = slot.event;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.seq.load(std::memory_order_relaxed) != expected)
+                {
+                    sub._lost++; // overwritten during the copy
+                    sub._cursor++;
+                    continue;
+                }
+                sub._cursor++;
+                return true;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,74 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_CHIPS_H
+#define CST816S_CHIPS_H
+
+// Capabilities of the Hynitron CST8xx family, identified by the ChipID register (0xA7)
+
+#include <stdint.h>
+
+struct chip_traits
+{
+    uint8_t chipID;        // Value of register 0xA7
+    const char *name;
+    uint8_t maxPoints;     // Touch points reported in register 0x02 onwards
+    uint32_t maxClock;     // Fastest I2C clock in Hz the part is specified for
+    bool gestures;         // Reports gestures in register 0x01
+    bool doubleClick;      // MotionMask (0xEC) EnDClick is available
+    bool autoSleepConfig;  // AutoSleepTime (0xF9) and DisAutoSleep (0xFE) are available
+    bool standby;          // Deep standby through register 0xA5
+    bool irqControl;       // IrqCtl (0xFA) selects which events raise the interrupt
+};
+
+/*!
+    @brief  look up the traits of a controller
+  @param	chipID
+      value read from register 0xA7
+  @return traits of the part, CST816S behaviour for unknown IDs
+*/
+static inline const chip_traits &cst816s_chip_traits(uint8_t chipID)
+{
+    static const chip_traits chips[] = {
+        {0xB4, "CST816S", 1, 400000, true, true, true, true, true},
+        {0xB5, "CST816T", 1, 400000, true, true, true, true, true},
+        {0xB6, "CST816D", 1, 400000, true, true, true, true, true},
+        {0xB7, "CST820", 1, 400000, true, true, true, true, true},
+        {0x20, "CST716", 1, 400000, true, false, false, true, false},
+    };
+    // the datasheets of all listed parts specify one touch point and Fast-mode; CST816S::setMaxPoints() and
+    // setMaxI2CClock(hz, true) go beyond that for firmware variants and boards known to handle it
+    static const chip_traits unknown = {0x00, "unknown", 1, 400000, true, true, true, true, true};
+
+    for (unsigned i = 0; i < sizeof(chips) / sizeof(chips[0]); i++)
+    {
+        if (chips[i].chipID == chipID)
+        {
+            return chips[i];
+        }
+    }
+    return unknown;
+}
+
+#endif
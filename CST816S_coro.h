@@ -0,0 +1,165 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_CORO_H
+#define CST816S_CORO_H
+
+// C++20 coroutine interface, available when the toolchain supports coroutines (-std=gnu++20)
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+#define CST816S_ANY_GESTURE 0xFF
+
+/*
+    Event sink that resumes coroutines waiting for touch events:
+
+        touch_event e = co_await touchAwait.nextEvent();
+        touch_event g = co_await touchAwait.nextGesture(SWIPE_LEFT);
+
+    Coroutines are resumed from the context that reads the touch data
+    (available()). The awaiter lives in the awaiting coroutine's frame and
+    is linked into an intrusive list, so awaiting does not allocate.
+*/
+class CST816S_Await : public CST816S_Sink
+{
+    public:
+        class Awaiter
+        {
+            public:
+                Awaiter(CST816S_Await &hub, bool gesture, uint8_t gestureID)
+                    : _hub(hub), _gesture(gesture), _gesture_id(gestureID) {}
+                Awaiter(const Awaiter &) = delete;
+                Awaiter &operator=(const Awaiter &) = delete;
+                // a coroutine destroyed while suspended must not stay linked
+                ~Awaiter() { _hub.unlink(this); }
+
+                bool await_ready() const { return false; }
+                void await_suspend(std::coroutine_handle<> handle)
+                {
+                    _handle = handle;
+                    _next = _hub._waiting;
+                    _hub._waiting = this;
+                }
+                touch_event await_resume() const { return _event; }
+
+            private:
+                friend class CST816S_Await;
+                CST816S_Await &_hub;
+                bool _gesture;
+                uint8_t _gesture_id;
+                touch_event _event;
+                std::coroutine_handle<> _handle;
+                Awaiter *_next = nullptr;
+
+                bool matches(const touch_event &event, bool newGesture) const
+                {
+                    if (!_gesture)
+                    {
+                        return true;
+                    }
+                    return newGesture && (_gesture_id == CST816S_ANY_GESTURE || _gesture_id == event.gestureID);
+                }
+        };
+
+        /*!
+            @brief  wait for the next touch event of any kind
+        */
+        Awaiter nextEvent() { return Awaiter(*this, false, 0); }
+
+        /*!
+            @brief  wait for the next gesture
+            @param  gestureID  gesture to wait for, CST816S_ANY_GESTURE for any
+        */
+        Awaiter nextGesture(uint8_t gestureID = CST816S_ANY_GESTURE) { return Awaiter(*this, true, gestureID); }
+
+        bool waiting() const { return _waiting != nullptr; }
+
+        void onTouchEvent(const touch_event &event) override
+        {
+            // the gesture register keeps its value over several reports, a gesture is new when it changes
+            bool newGesture = event.gestureID != NONE && event.gestureID != _last_gesture;
+            _last_gesture = event.gestureID;
+
+            // detach the list first, coroutines resumed below may wait again and must not see this event
+            _resuming = _waiting;
+            _waiting = nullptr;
+            while (_resuming != nullptr)
+            {
+                // unlinked before resuming: a resumed coroutine may destroy any other waiting one
+                Awaiter *awaiter = _resuming;
+                _resuming = awaiter->_next;
+                awaiter->_next = nullptr;
+                if (awaiter->matches(event, newGesture))
+                {
+                    awaiter->_event = event;
+                    awaiter->_handle.resume();
+                }
+                else
+                {
+                    // keep waiting, appended after anything that started waiting during a resume
+                    Awaiter **keep = &_waiting;
+                    while (*keep != nullptr)
+                    {
+                        keep = &(*keep)->_next;
+                    }
+                    *keep = awaiter;
+                }
+            }
+        }
+
+    private:
+        Awaiter *_waiting = nullptr;
+        Awaiter *_resuming = nullptr; // rest of the list detached by onTouchEvent()
+        uint8_t _last_gesture = NONE;
+
+        void unlink(Awaiter *awaiter)
+        {
+            if (!remove(&_waiting, awaiter))
+            {
+                remove(&_resuming, awaiter);
+            }
+        }
+
+        static bool remove(Awaiter **link, Awaiter *awaiter)
+        {
+            for (; *link != nullptr; link = &(*link)->_next)
+            {
+                if (*link == awaiter)
+                {
+                    *link = awaiter->_next;
+                    return true;
+                }
+            }
+            return false;
+        }
+};
+
+#endif
+
+#endif
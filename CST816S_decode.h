@@ -0,0 +1,229 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_DECODE_H
+#define CST816S_DECODE_H
+
+// Report decoding shared by the driver and host tools, kept free of Arduino dependencies
+
+#include <stdint.h>
+
+#include "CST816S_regs.h"
+
+enum GESTURE
+{
+    NONE = 0x00,
+    SWIPE_UP = 0x01,
+    SWIPE_DOWN = 0x02,
+    SWIPE_LEFT = 0x03,
+    SWIPE_RIGHT = 0x04,
+    SINGLE_CLICK = 0x05,
+    DOUBLE_CLICK = 0x0B,
+    LONG_PRESS = 0x0C
+};
+
+// Event classes for subscription masks, see cst816s_event_class()
+#define CST816S_EVENT_GESTURE 0x01    // a new gesture other than LONG_PRESS
+#define CST816S_EVENT_EDGE 0x02       // finger down or up
+#define CST816S_EVENT_MOVE 0x04       // contact report while the finger is down
+#define CST816S_EVENT_LONG_PRESS 0x08 // a new LONG_PRESS gesture
+#define CST816S_EVENT_ALL 0x0F
+
+struct touch_event
+{
+    uint8_t gestureID; // Gesture ID
+    uint8_t points;    // Number of touch points
+    uint8_t event;     // Event (0 = Down, 1 = Up, 2 = Contact)
+    int x;
+    int y;
+    uint32_t timestamp; // Microseconds at the interrupt that signalled the report, wraps after ~71 minutes
+};
+
+struct touch_point
+{
+    uint8_t id;    // Touch ID, stays the same while the finger is down
+    uint8_t event; // Event (0 = Down, 1 = Up, 2 = Contact)
+    int x;
+    int y;
+};
+
+enum TOUCH_ERROR
+{
+    ERROR_NACK = 0x01,          // transfer not acknowledged
+    ERROR_SHORT_READ = 0x02,    // fewer bytes returned than requested
+    ERROR_INVALID_FRAME = 0x03, // report with impossible contents
+    ERROR_RECOVERY = 0x04       // controller and bus were reset
+};
+
+/*
+    Receives every decoded touch event, see CST816S::addSink(). Called from
+    the context that reads the touch data, so implementations must be short.
+*/
+class CST816S_Sink
+{
+    public:
+        virtual ~CST816S_Sink() {}
+        virtual void onTouchEvent(const touch_event &event) = 0;
+        virtual void onTouchError(uint8_t /*error*/, uint32_t /*timestamp*/) {}
+        virtual void onTouchPoints(const touch_point * /*points*/, uint8_t /*count*/, uint32_t /*timestamp*/) {}
+};
+
+/*!
+    @brief  decode a report frame read from register 0x01
+  @param	raw
+      6 bytes: gesture, points, XH (event in bits 7-6), XL, YH, YL
+  @param	event
+      decoded event, not rotated, timestamp left unchanged
+*/
+static inline void cst816s_decode(const uint8_t *raw, touch_event &event)
+{
+    const uint8_t base = CST816S_REG_GESTURE_ID::address;
+    const uint8_t xh = raw[CST816S_REG_XPOS_H::offset<base>()];
+    const uint8_t yh = raw[CST816S_REG_YPOS_H::offset<base>()];
+
+    event.gestureID = raw[CST816S_REG_GESTURE_ID::offset<base>()];
+    event.points = raw[CST816S_REG_FINGER_NUM::offset<base>()];
+    event.event = CST816S_EVENT_FLAG::decode(xh);
+    event.x = (CST816S_XPOS_HIGH::decode(xh) << 8) + raw[CST816S_REG_XPOS_L::offset<base>()];
+    event.y = (CST816S_YPOS_HIGH::decode(yh) << 8) + raw[CST816S_REG_YPOS_L::offset<base>()];
+}
+
+/*!
+    @brief  decode one touch point of a report
+  @param	raw
+      4 bytes: XH (event in bits 7-6), XL, YH (touch ID in bits 7-4), YL;
+      point n starts at register 0x03 + 6 * n
+  @param	point
+      decoded point, not rotated
+*/
+static inline void cst816s_decode_point(const uint8_t *raw, touch_point &point)
+{
+    const uint8_t base = CST816S_REG_XPOS_H::address;
+
+    point.event = CST816S_EVENT_FLAG::decode(raw[0]);
+    point.id = CST816S_TOUCH_ID::decode(raw[CST816S_REG_YPOS_H::offset<base>()]);
+    point.x = (CST816S_XPOS_HIGH::decode(raw[0]) << 8) + raw[CST816S_REG_XPOS_L::offset<base>()];
+    point.y = (CST816S_YPOS_HIGH::decode(raw[CST816S_REG_YPOS_H::offset<base>()]) << 8) + raw[CST816S_REG_YPOS_L::offset<base>()];
+}
+
+/*!
+    @brief  classify an event for subscription masks
+  @param	event
+      decoded event
+  @param	lastGesture
+      gestureID of the previous event, the gesture register keeps its value over several reports
+  @return CST816S_EVENT_* bits describing the event
+*/
+static inline uint8_t cst816s_event_class(const touch_event &event, uint8_t lastGesture)
+{
+    uint8_t classes = event.event == 2 ? CST816S_EVENT_MOVE : CST816S_EVENT_EDGE;
+    if (event.gestureID != NONE && event.gestureID != lastGesture)
+    {
+        classes |= event.gestureID == LONG_PRESS ? CST816S_EVENT_LONG_PRESS : CST816S_EVENT_GESTURE;
+    }
+    return classes;
+}
+
+/*!
+    @brief  map a swipe gesture to the screen rotation (0-3)
+*/
+static inline uint8_t cst816s_rotate_gesture(uint8_t gestureID, int rotation)
+{
+    static const uint8_t rotation90[5] = {0, 0x03, 0x04, 0x02, 0x01};
+    static const uint8_t rotation180[5] = {0, 0x02, 0x01, 0x04, 0x03};
+    static const uint8_t rotation270[5] = {0, 0x04, 0x03, 0x01, 0x02};
+    // checking if non rotation specific gesture
+    if (gestureID < 1 || gestureID > 4 || rotation == 0)
+    {
+        return gestureID;
+    }
+
+    switch (rotation)
+    {
+    case 1:
+        return rotation90[gestureID];
+    case 2:
+        return rotation180[gestureID];
+    case 3:
+        return rotation270[gestureID];
+    default:
+        return gestureID; // No rotation or unknown rotation
+    }
+}
+
+/*!
+    @brief  map a panel point to the screen rotation (0-3)
+*/
+static inline void cst816s_rotate_point(int &x, int &y, int rotation, int width, int height)
+{
+    int oldX = x;
+    int oldY = y;
+    switch (rotation)
+    {
+    case 1:
+        x = oldY;
+        y = width - 1 - oldX;
+        break;
+    case 2:
+        x = width  - 1 - oldX;
+        y = height - 1 - oldY;
+        break;
+    case 3:
+        x = height - 1 - oldY;
+        y = oldX;
+        break;
+    default: // No rotation or unknown rotation
+        break;
+    }
+}
+
+/*!
+    @brief  get the gesture name
+*/
+static inline const char *cst816s_gesture_name(uint8_t gestureID)
+{
+    switch (gestureID)
+    {
+    case NONE:
+        return "NONE";
+    case SWIPE_DOWN:
+        return "SWIPE DOWN";
+    case SWIPE_UP:
+        return "SWIPE UP";
+    case SWIPE_LEFT:
+        return "SWIPE LEFT";
+    case SWIPE_RIGHT:
+        return "SWIPE RIGHT";
+    case SINGLE_CLICK:
+        return "SINGLE CLICK";
+    case DOUBLE_CLICK:
+        return "DOUBLE CLICK";
+    case LONG_PRESS:
+        return "LONG PRESS";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "CST816S_dirty.h"
+
+/*!
+    @brief  Constructor for CST816S_Dirty
+*/
+CST816S_Dirty::CST816S_Dirty(int width, int height, uint8_t margin, uint16_t leadMs)
+{
+    _width = width;
+    _height = height;
+    _margin = margin;
+    _lead_us = (uint32_t)leadMs * 1000;
+}
+
+/*!
+    @brief  add the points of one report to the box of the current frame
+*/
+void CST816S_Dirty::onTouchPoints(const touch_point *points, uint8_t count, uint32_t timestamp)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    int box[4] = {points[0].x, points[0].y, points[0].x, points[0].y};
+    for (int i = 0; i < count; i++)
+    {
+        grow(box, points[i].x, points[i].y, _margin);
+    }
+
+    bool up = points[0].event == 1;
+    if (_lead_us && _has_last && !up)
+    {
+        // linear extrapolation of the primary point
+        uint32_t dt = timestamp - _last_time;
+        if (dt > 0 && dt < _lead_us * 4)
+        {
+            int px = points[0].x + (int)((int64_t)(points[0].x - _last_x) * _lead_us / dt);
+            int py = points[0].y + (int)((int64_t)(points[0].y - _last_y) * _lead_us / dt);
+            grow(box, px, py, _margin);
+        }
+    }
+
+    bool moved = !_has_last;
+    for (int i = 0; i < 4 && !moved; i++)
+    {
+        moved = box[i] != _last_box[i];
+    }
+    if (moved || up)
+    {
+        if (!_dirty)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                _box[i] = _has_last ? _last_box[i] : box[i];
+            }
+            _dirty = true;
+        }
+        grow(_box, box[0], box[1], 0);
+        grow(_box, box[2], box[3], 0);
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        _last_box[i] = box[i];
+    }
+    _has_last = !up;
+    _last_x = points[0].x;
+    _last_y = points[0].y;
+    _last_time = timestamp;
+}
+
+/*!
+    @brief  take the region to redraw for this frame and start the next one
+  @param	rect
+      filled with the region, clipped to the screen
+  @return false if there was no touch activity since the last call
+*/
+bool CST816S_Dirty::take(dirty_rect &rect)
+{
+    if (!_dirty)
+    {
+        return false;
+    }
+    _dirty = false;
+
+    int x0 = _box[0] < 0 ? 0 : _box[0];
+    int y0 = _box[1] < 0 ? 0 : _box[1];
+    int x1 = _box[2] >= _width ? _width - 1 : _box[2];
+    int y1 = _box[3] >= _height ? _height - 1 : _box[3];
+    if (x1 < x0 || y1 < y0)
+    {
+        return false;
+    }
+    rect.x = x0;
+    rect.y = y0;
+    rect.w = x1 - x0 + 1;
+    rect.h = y1 - y0 + 1;
+    _pixels += (uint64_t)rect.w * rect.h;
+    return true;
+}
+
+void CST816S_Dirty::grow(int *box, int x, int y, int margin)
+{
+    if (x - margin < box[0])
+    {
+        box[0] = x - margin;
+    }
+    if (y - margin < box[1])
+    {
+        box[1] = y - margin;
+    }
+    if (x + margin > box[2])
+    {
+        box[2] = x + margin;
+    }
+    if (y + margin > box[3])
+    {
+        box[3] = y + margin;
+    }
+}
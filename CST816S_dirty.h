@@ -0,0 +1,83 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_DIRTY_H
+#define CST816S_DIRTY_H
+
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+struct dirty_rect
+{
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+/*
+    Bounding box of touch activity per display frame, to limit partial
+    updates to the region a touch can have affected. Each report is widened
+    by a margin for the drawn cursor or brush and filter lag, and optionally
+    extended along the motion to where the finger is predicted to be. The
+    box of a frame also covers the last report of the previous frame, so
+    whatever was drawn there is redrawn too. Reports that do not move are
+    ignored.
+*/
+class CST816S_Dirty : public CST816S_Sink
+{
+    public:
+        /*!
+            @param  width  screen width, rectangles are clipped to the screen
+            @param  height  screen height
+            @param  margin  pixels added around each touch point
+            @param  leadMs  prediction horizon, 0 to disable prediction
+        */
+        CST816S_Dirty(int width, int height, uint8_t margin = 8, uint16_t leadMs = 0);
+
+        void onTouchEvent(const touch_event & /*event*/) override {}
+        void onTouchPoints(const touch_point *points, uint8_t count, uint32_t timestamp) override;
+
+        bool take(dirty_rect &rect);
+        uint64_t pixels() const { return _pixels; }
+
+    private:
+        int _width;
+        int _height;
+        uint8_t _margin;
+        uint32_t _lead_us;
+        bool _dirty = false;
+        int _box[4];            // x0, y0, x1, y1 of the current frame, inclusive
+        int _last_box[4];       // of the last report
+        bool _has_last = false;
+        int _last_x;            // primary point of the last report, for prediction
+        int _last_y;
+        uint32_t _last_time;
+        uint64_t _pixels = 0;   // area of all rectangles returned by take()
+
+        static void grow(int *box, int x, int y, int margin);
+};
+
+#endif
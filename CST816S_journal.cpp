@@ -0,0 +1,154 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <atomic>
+
+#include "CST816S_journal.h"
+
+#define JOURNAL_MAGIC 0x4A363138UL // "816J"
+
+/*!
+    @brief  check word of an entry, it depends on the sequence number so a stale entry in the slot does not pass
+*/
+static inline uint32_t journal_check(uint32_t seq, uint32_t w0, uint32_t w1)
+{
+    return ((seq ^ JOURNAL_MAGIC) * 0x9E3779B1UL) ^ w0 ^ ((w1 << 13) | (w1 >> 19));
+}
+
+/*!
+    @brief  validate the journal left by the previous run, entries that fail their check are dropped
+    @return true if the previous journal was found, otherwise it is cleared
+*/
+bool CST816S_Journal::begin()
+{
+    if (_region.magic != JOURNAL_MAGIC || _region.written - _region.first > CST816S_JOURNAL_SIZE)
+    {
+        clear();
+        return false;
+    }
+
+    // an entry completed just before the reset, before written was advanced
+    if (valid_entry(_region.written))
+    {
+        _region.written++;
+    }
+    // keep the newest entries up to the first one that fails, the one an interrupted append() overwrote
+    uint32_t kept = 0;
+    while (kept < CST816S_JOURNAL_SIZE && kept < _region.written && valid_entry(_region.written - 1 - kept))
+    {
+        kept++;
+    }
+    _region.first = _region.written - kept;
+    return true;
+}
+
+/*!
+    @brief  discard all entries
+*/
+void CST816S_Journal::clear()
+{
+    for (size_t i = 0; i < CST816S_JOURNAL_SIZE; i++)
+    {
+        _region.entries[i][0] = 0;
+        _region.entries[i][1] = 0;
+        _region.entries[i][2] = 0;
+    }
+    _region.written = 0;
+    _region.first = 0;
+    _region.magic = JOURNAL_MAGIC;
+}
+
+void CST816S_Journal::onTouchEvent(const touch_event &event)
+{
+    append(event.timestamp, event.event & 0x03, event.gestureID, event.x, event.y);
+}
+
+void CST816S_Journal::onTouchError(uint8_t error, uint32_t timestamp)
+{
+    append(timestamp, CST816S_JOURNAL_ERROR | error, 0, 0, 0);
+}
+
+/*!
+    @brief  number of entries available, at most CST816S_JOURNAL_SIZE
+*/
+size_t CST816S_Journal::count() const
+{
+    return _region.written - _region.first;
+}
+
+/*!
+    @brief  read an entry
+  @param	index
+      0 is the oldest entry, count() - 1 the newest
+  @param	entry
+      unpacked entry
+  @return false if index is out of range
+*/
+bool CST816S_Journal::entry(size_t index, journal_entry &entry) const
+{
+    if (index >= count())
+    {
+        return false;
+    }
+    size_t slot = (_region.first + index) % CST816S_JOURNAL_SIZE;
+    uint32_t w0 = _region.entries[slot][0];
+    uint32_t w1 = _region.entries[slot][1];
+    entry.timestamp = w0;
+    entry.kind = w1 & 0xFF;
+    entry.gestureID = (w1 >> 8) & 0x0F;
+    entry.x = (w1 >> 12) & 0x3FF;
+    entry.y = (w1 >> 22) & 0x3FF;
+    return true;
+}
+
+/*!
+    @brief  pack and store an entry: kind 8 bits, gesture 4 bits, x and y 10 bits each
+*/
+void CST816S_Journal::append(uint32_t timestamp, uint8_t kind, uint8_t gestureID, int x, int y)
+{
+    x = x < 0 ? 0 : (x > 0x3FF ? 0x3FF : x);
+    y = y < 0 ? 0 : (y > 0x3FF ? 0x3FF : y);
+    uint32_t w0 = timestamp;
+    uint32_t w1 = kind | ((uint32_t)(gestureID & 0x0F) << 8) | ((uint32_t)x << 12) | ((uint32_t)y << 22);
+
+    // the check word is stored last, a reset before it leaves an entry that fails
+    uint32_t seq = _region.written;
+    uint32_t *entry = _region.entries[seq % CST816S_JOURNAL_SIZE];
+    entry[0] = w0;
+    entry[1] = w1;
+    std::atomic_signal_fence(std::memory_order_release); // keep the compiler from reordering the stores
+    entry[2] = journal_check(seq, w0, w1);
+    std::atomic_signal_fence(std::memory_order_release);
+    _region.written = seq + 1;
+    if (seq + 1 - _region.first > CST816S_JOURNAL_SIZE)
+    {
+        _region.first = seq + 1 - CST816S_JOURNAL_SIZE;
+    }
+}
+
+bool CST816S_Journal::valid_entry(uint32_t seq) const
+{
+    const uint32_t *entry = _region.entries[seq % CST816S_JOURNAL_SIZE];
+    return entry[2] == journal_check(seq, entry[0], entry[1]);
+}
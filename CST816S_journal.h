@@ -0,0 +1,96 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_JOURNAL_H
+#define CST816S_JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+// Number of entries kept, older entries are overwritten
+#ifndef CST816S_JOURNAL_SIZE
+#define CST816S_JOURNAL_SIZE 32
+#endif
+
+// Placement of journal_region variables, defaults to RTC memory that survives resets and deep sleep
+#ifndef CST816S_JOURNAL_ATTR
+#if defined(ESP_PLATFORM)
+#include <esp_attr.h>
+#define CST816S_JOURNAL_ATTR RTC_NOINIT_ATTR
+#else
+#define CST816S_JOURNAL_ATTR
+#endif
+#endif
+
+#define CST816S_JOURNAL_ERROR 0x80 // kind flag, the low bits hold a TOUCH_ERROR
+
+struct journal_entry
+{
+    uint32_t timestamp; // Microseconds, as in touch_event
+    uint8_t kind;       // Event (0-2) or CST816S_JOURNAL_ERROR | TOUCH_ERROR
+    uint8_t gestureID;
+    int x;
+    int y;
+};
+
+/*
+    Storage of the journal, place it in memory that is not cleared on reset:
+        CST816S_JOURNAL_ATTR journal_region touchJournalRegion;
+    Entries are packed into 8 bytes plus a check word derived from the
+    entry and its sequence number. An entry torn by a reset in the middle of
+    append() fails its own check, so begin() drops it and the entries it
+    overwrote but keeps the rest.
+*/
+struct journal_region
+{
+    uint32_t magic;
+    uint32_t written;  // total entries written, the next one goes to written % CST816S_JOURNAL_SIZE
+    uint32_t first;    // sequence number of the oldest entry kept
+    uint32_t entries[CST816S_JOURNAL_SIZE][3];
+};
+
+class CST816S_Journal : public CST816S_Sink
+{
+    public:
+        CST816S_Journal(journal_region &region) : _region(region) {}
+
+        bool begin();
+        void clear();
+
+        void onTouchEvent(const touch_event &event) override;
+        void onTouchError(uint8_t error, uint32_t timestamp) override;
+
+        size_t count() const;
+        bool entry(size_t index, journal_entry &entry) const;
+
+    private:
+        journal_region &_region;
+
+        void append(uint32_t timestamp, uint8_t kind, uint8_t gestureID, int x, int y);
+        bool valid_entry(uint32_t seq) const;
+};
+
+#endif
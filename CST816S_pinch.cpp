@@ -0,0 +1,99 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <math.h>
+
+#include "CST816S_pinch.h"
+
+/*!
+    @brief  Constructor for CST816S_Pinch
+*/
+CST816S_Pinch::CST816S_Pinch(float scaleThreshold, float rotateThreshold)
+{
+    _scale_threshold = scaleThreshold;
+    _rotate_threshold = rotateThreshold;
+}
+
+/*!
+    @brief  update the tracker with the points of one report
+*/
+void CST816S_Pinch::onTouchPoints(const touch_point *points, uint8_t count, uint32_t /*timestamp*/)
+{
+    if (count < 2 || points[0].event == 1 || points[1].event == 1)
+    {
+        _active = false;
+        _gesture = MULTI_NONE;
+        return;
+    }
+
+    float dx = points[1].x - points[0].x;
+    float dy = points[1].y - points[0].y;
+    float distance = sqrtf(dx * dx + dy * dy);
+    float angle = atan2f(dy, dx) * 57.29578f; // degrees
+    _center_x = (points[0].x + points[1].x) / 2;
+    _center_y = (points[0].y + points[1].y) / 2;
+
+    if (!_active || points[0].id != _ids[0] || points[1].id != _ids[1])
+    {
+        // a new pair of fingers, measure relative to here
+        _active = true;
+        _ids[0] = points[0].id;
+        _ids[1] = points[1].id;
+        _start_distance = distance > 1.0f ? distance : 1.0f;
+        _start_angle = angle;
+        _scale = 1.0f;
+        _rotation = 0.0f;
+        _gesture = MULTI_NONE;
+        return;
+    }
+
+    _scale = distance / _start_distance;
+    _rotation = angle - _start_angle;
+    if (_rotation > 180.0f)
+    {
+        _rotation -= 360.0f;
+    }
+    else if (_rotation < -180.0f)
+    {
+        _rotation += 360.0f;
+    }
+
+    // screen y grows downwards, so a positive angle change is clockwise
+    if (fabsf(_rotation) >= _rotate_threshold)
+    {
+        _gesture = _rotation > 0 ? ROTATE_CW : ROTATE_CCW;
+    }
+    else if (_scale >= 1.0f + _scale_threshold)
+    {
+        _gesture = PINCH_OUT;
+    }
+    else if (_scale <= 1.0f - _scale_threshold)
+    {
+        _gesture = PINCH_IN;
+    }
+    else
+    {
+        _gesture = MULTI_NONE;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_PINCH_H
+#define CST816S_PINCH_H
+
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+enum MULTI_GESTURE
+{
+    MULTI_NONE = 0x00,
+    PINCH_IN = 0x01,    // fingers moved together (zoom out)
+    PINCH_OUT = 0x02,   // fingers moved apart (zoom in)
+    ROTATE_CW = 0x03,
+    ROTATE_CCW = 0x04
+};
+
+/*
+    Two finger gesture tracker fed with the touch points of each report.
+    Scale and rotation are relative to the positions where the second finger
+    went down and are valid while active() is true.
+*/
+class CST816S_Pinch : public CST816S_Sink
+{
+    public:
+        /*!
+            @param  scaleThreshold  relative distance change reported as a pinch, e.g. 0.15
+            @param  rotateThreshold  angle change in degrees reported as a rotation
+        */
+        CST816S_Pinch(float scaleThreshold = 0.15f, float rotateThreshold = 15.0f);
+
+        void onTouchEvent(const touch_event & /*event*/) override {}
+        void onTouchPoints(const touch_point *points, uint8_t count, uint32_t timestamp) override;
+
+        bool active() const { return _active; }
+        float scale() const { return _scale; }
+        float rotation() const { return _rotation; }
+        int centerX() const { return _center_x; }
+        int centerY() const { return _center_y; }
+        uint8_t gesture() const { return _gesture; }
+
+    private:
+        float _scale_threshold;
+        float _rotate_threshold;
+        bool _active = false;
+        uint8_t _ids[2];
+        float _start_distance;
+        float _start_angle;
+        float _scale = 1.0f;
+        float _rotation = 0.0f;
+        int _center_x = 0;
+        int _center_y = 0;
+        uint8_t _gesture = MULTI_NONE;
+};
+
+#endif
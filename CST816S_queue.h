@@ -0,0 +1,176 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_QUEUE_H
+#define CST816S_QUEUE_H
+
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+// Number of decoded events buffered between read_touch() and readEvent(), must be a power of two
+#ifndef CST816S_EVENT_QUEUE_SIZE
+#define CST816S_EVENT_QUEUE_SIZE 8
+#endif
+
+enum QUEUE_POLICY
+{
+    QUEUE_DROP_NEWEST = 0x00, // keep what is queued, discard the new event
+    QUEUE_DROP_OLDEST = 0x01, // discard the oldest queued event
+    QUEUE_MERGE_MOVES = 0x02, // fold a new move into a queued move, otherwise drop the oldest
+    QUEUE_KEEP_EDGES = 0x03   // discard moves only, down/up edges and gestures are kept
+};
+
+struct queue_stats
+{
+    uint32_t droppedNewest; // new events discarded
+    uint32_t droppedOldest; // queued events discarded
+    uint32_t merged;        // moves folded into the newest queued move
+    uint32_t droppedEdges;  // edges or gestures discarded, only when the queue holds nothing else
+};
+
+/*
+    Fixed size event FIFO with a selectable overflow policy. Not thread safe,
+    CST816S serializes access to it.
+*/
+class CST816S_EventQueue
+{
+    public:
+        void setPolicy(uint8_t policy) { _policy = policy; }
+        uint8_t policy() const { return _policy; }
+
+        /*!
+            @brief  a contact report that does not start a gesture, the only kind of event that can be merged or dropped first
+          @param	classes
+              CST816S_EVENT_* bits of the event, see cst816s_event_class()
+        */
+        static bool is_move(uint8_t classes)
+        {
+            return classes == CST816S_EVENT_MOVE;
+        }
+
+        uint8_t size() const { return _head - _tail; }
+        const queue_stats &stats() const { return _stats; }
+
+        uint32_t dropped() const
+        {
+            return _stats.droppedNewest + _stats.droppedOldest + _stats.droppedEdges;
+        }
+
+        bool pop(touch_event &event)
+        {
+            if (_head == _tail)
+            {
+                return false;
+            }
+            event = at(_tail++);
+            return true;
+        }
+
+        /*!
+            @brief  append an event, applying the overflow policy when the queue is full
+          @param	classes
+              CST816S_EVENT_* bits of the event; the gesture register keeps its value over
+              several reports, so only the classification tells a swipe's moves from its start
+        */
+        void push(const touch_event &event, uint8_t classes)
+        {
+            static_assert((CST816S_EVENT_QUEUE_SIZE & (CST816S_EVENT_QUEUE_SIZE - 1)) == 0 && CST816S_EVENT_QUEUE_SIZE <= 128,
+                          "CST816S_EVENT_QUEUE_SIZE must be a power of two no larger than 128");
+
+            if (size() >= CST816S_EVENT_QUEUE_SIZE && !make_room(event, classes))
+            {
+                return;
+            }
+            at(_head) = event;
+            classes_at(_head++) = classes;
+        }
+
+    private:
+        touch_event _queue[CST816S_EVENT_QUEUE_SIZE];
+        uint8_t _classes[CST816S_EVENT_QUEUE_SIZE];
+        uint8_t _head = 0;
+        uint8_t _tail = 0;
+        uint8_t _policy = QUEUE_DROP_NEWEST;
+        queue_stats _stats = {};
+
+        touch_event &at(uint8_t index) { return _queue[index & (CST816S_EVENT_QUEUE_SIZE - 1)]; }
+        uint8_t &classes_at(uint8_t index) { return _classes[index & (CST816S_EVENT_QUEUE_SIZE - 1)]; }
+
+        /*!
+            @brief  apply the overflow policy to a full queue
+            @return true if the event should still be appended
+        */
+        bool make_room(const touch_event &event, uint8_t classes)
+        {
+            switch (_policy)
+            {
+            case QUEUE_DROP_OLDEST:
+                _tail++;
+                _stats.droppedOldest++;
+                return true;
+
+            case QUEUE_MERGE_MOVES:
+                if (is_move(classes) && is_move(classes_at(_head - 1)))
+                {
+                    at(_head - 1) = event; // the newer position supersedes the queued one
+                    _stats.merged++;
+                    return false;
+                }
+                _tail++;
+                _stats.droppedOldest++;
+                return true;
+
+            case QUEUE_KEEP_EDGES:
+                if (is_move(classes))
+                {
+                    _stats.droppedNewest++;
+                    return false;
+                }
+                // remove the oldest queued move, shifting the older events up
+                for (uint8_t i = _tail; i != _head; i++)
+                {
+                    if (is_move(classes_at(i)))
+                    {
+                        for (uint8_t j = i; j != _tail; j--)
+                        {
+                            at(j) = at(j - 1);
+                            classes_at(j) = classes_at(j - 1);
+                        }
+                        _tail++;
+                        _stats.droppedOldest++;
+                        return true;
+                    }
+                }
+                _stats.droppedEdges++;
+                return false;
+
+            default:
+                _stats.droppedNewest++;
+                return false;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,135 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_REGS_H
+#define CST816S_REGS_H
+
+/*
+    Register map of the CST816S family. Fields know their register, so
+    encoding, decoding and combining values is resolved at compile time:
+
+        write_reg(CST816S_EN_TOUCH::set(1) | CST816S_EN_MOTION::set(1));
+
+    composes a single IrqCtl byte, and or-ing fields of different registers
+    does not compile.
+*/
+
+#include <stdint.h>
+
+template <uint8_t Address>
+struct cst816s_reg
+{
+    static constexpr uint8_t address = Address;
+
+    /*!
+        @brief  index of this register in a burst read starting at register Base
+    */
+    template <uint8_t Base>
+    static constexpr uint8_t offset()
+    {
+        static_assert(Address >= Base, "register lies before the start of the burst");
+        return Address - Base;
+    }
+};
+
+// Encoded value of one or more fields of register Reg
+template <typename Reg>
+struct cst816s_value
+{
+    uint8_t bits;
+
+    constexpr cst816s_value operator|(cst816s_value other) const
+    {
+        return cst816s_value{(uint8_t)(bits | other.bits)};
+    }
+};
+
+template <typename Reg, uint8_t Shift, uint8_t Width>
+struct cst816s_field
+{
+    static_assert(Width > 0 && Shift + Width <= 8, "field must fit in one register");
+
+    typedef Reg reg;
+    static constexpr uint8_t mask = (uint8_t)(((1u << Width) - 1) << Shift);
+
+    static constexpr uint8_t encode(uint8_t value) { return (uint8_t)((value << Shift) & mask); }
+    static constexpr uint8_t decode(uint8_t raw) { return (uint8_t)((raw & mask) >> Shift); }
+    static constexpr cst816s_value<Reg> set(uint8_t value) { return cst816s_value<Reg>{encode(value)}; }
+};
+
+// Touch report, read as one burst from CST816S_REG_GESTURE_ID
+typedef cst816s_reg<0x01> CST816S_REG_GESTURE_ID;
+typedef cst816s_reg<0x02> CST816S_REG_FINGER_NUM;
+typedef cst816s_reg<0x03> CST816S_REG_XPOS_H;
+typedef cst816s_reg<0x04> CST816S_REG_XPOS_L;
+typedef cst816s_reg<0x05> CST816S_REG_YPOS_H;
+typedef cst816s_reg<0x06> CST816S_REG_YPOS_L;
+typedef cst816s_reg<0x09> CST816S_REG_XPOS_H2; // second touch point, same layout as 0x03-0x06
+
+typedef cst816s_field<CST816S_REG_XPOS_H, 6, 2> CST816S_EVENT_FLAG;   // 0 = Down, 1 = Up, 2 = Contact
+typedef cst816s_field<CST816S_REG_XPOS_H, 0, 4> CST816S_XPOS_HIGH;
+typedef cst816s_field<CST816S_REG_YPOS_H, 4, 4> CST816S_TOUCH_ID;
+typedef cst816s_field<CST816S_REG_YPOS_H, 0, 4> CST816S_YPOS_HIGH;
+
+// Identification
+typedef cst816s_reg<0x15> CST816S_REG_VERSION;
+typedef cst816s_reg<0xA7> CST816S_REG_CHIP_ID;    // followed by ProjID (0xA8) and FwVersion (0xA9)
+
+// Power and configuration
+typedef cst816s_reg<0xA5> CST816S_REG_DEEP_SLEEP;
+typedef cst816s_field<CST816S_REG_DEEP_SLEEP, 0, 8> CST816S_DEEP_SLEEP; // 0x03 enters deep standby
+
+typedef cst816s_reg<0xEC> CST816S_REG_MOTION_MASK;
+typedef cst816s_field<CST816S_REG_MOTION_MASK, 2, 1> CST816S_EN_CON_LR;  // continuous left/right swipes
+typedef cst816s_field<CST816S_REG_MOTION_MASK, 1, 1> CST816S_EN_CON_UD;  // continuous up/down swipes
+typedef cst816s_field<CST816S_REG_MOTION_MASK, 0, 1> CST816S_EN_DCLICK;  // double click gesture
+
+typedef cst816s_reg<0xF9> CST816S_REG_AUTO_SLEEP_TIME;
+typedef cst816s_field<CST816S_REG_AUTO_SLEEP_TIME, 0, 8> CST816S_AUTO_SLEEP_TIME; // seconds
+
+typedef cst816s_reg<0xFA> CST816S_REG_IRQ_CTL;
+typedef cst816s_field<CST816S_REG_IRQ_CTL, 7, 1> CST816S_EN_TEST;    // periodic test interrupts
+typedef cst816s_field<CST816S_REG_IRQ_CTL, 6, 1> CST816S_EN_TOUCH;   // interrupts while touched
+typedef cst816s_field<CST816S_REG_IRQ_CTL, 5, 1> CST816S_EN_CHANGE;  // interrupt on touch state change
+typedef cst816s_field<CST816S_REG_IRQ_CTL, 4, 1> CST816S_EN_MOTION;  // interrupt on gestures
+typedef cst816s_field<CST816S_REG_IRQ_CTL, 0, 1> CST816S_ONCE_WLP;   // one interrupt per long press
+
+typedef cst816s_reg<0xFB> CST816S_REG_AUTO_RESET;      // seconds of touch without gesture before a reset, 0 = off
+typedef cst816s_reg<0xFC> CST816S_REG_LONG_PRESS_TIME; // seconds of long press before a reset, 0 = off
+typedef cst816s_reg<0xFD> CST816S_REG_IO_CTL;
+
+typedef cst816s_reg<0xFE> CST816S_REG_DIS_AUTO_SLEEP;
+typedef cst816s_field<CST816S_REG_DIS_AUTO_SLEEP, 0, 8> CST816S_DIS_AUTO_SLEEP; // non-zero disables auto sleep
+
+// compile-time checks of the layout and of encode/decode
+static_assert(CST816S_REG_XPOS_H::offset<CST816S_REG_GESTURE_ID::address>() == 2, "report layout");
+static_assert(CST816S_REG_YPOS_L::offset<CST816S_REG_GESTURE_ID::address>() == 5, "report layout");
+static_assert(CST816S_EVENT_FLAG::decode(0x8A) == 2 && CST816S_XPOS_HIGH::decode(0x8A) == 0x0A, "event and X high bits");
+static_assert(CST816S_TOUCH_ID::decode(0x13) == 1 && CST816S_YPOS_HIGH::decode(0x13) == 3, "touch ID and Y high bits");
+static_assert(CST816S_EVENT_FLAG::encode(1) == 0x40 && CST816S_EVENT_FLAG::encode(4) == 0x00, "encode masks the value");
+static_assert((CST816S_EN_TOUCH::set(1) | CST816S_EN_CHANGE::set(1) | CST816S_ONCE_WLP::set(1)).bits == 0x61, "IrqCtl composition");
+static_assert(CST816S_EN_DCLICK::set(1).bits == 0x01, "EnDClick");
+static_assert(CST816S_REG_DIS_AUTO_SLEEP::offset<CST816S_REG_AUTO_SLEEP_TIME::address>() == 5, "power block layout");
+
+#endif
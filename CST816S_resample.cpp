@@ -0,0 +1,203 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "CST816S_resample.h"
+
+/*!
+    @brief  Constructor for CST816S_Resampler
+  @param	rateHz
+      output rate
+  @param	maxGapMs
+      longest report interval that is interpolated with the spline
+*/
+CST816S_Resampler::CST816S_Resampler(uint16_t rateHz, uint16_t maxGapMs)
+{
+    _period_us = 1000000UL / (rateHz ? rateHz : 1);
+    _max_gap_us = (uint32_t)maxGapMs * 1000;
+}
+
+/*!
+    @brief  take the oldest resampled point
+    @return false if none is buffered
+*/
+bool CST816S_Resampler::read(resampled_point &point)
+{
+    if (_head == _tail)
+    {
+        return false;
+    }
+    point = _queue[_tail++ & (CST816S_RESAMPLE_QUEUE - 1)];
+    return true;
+}
+
+/*!
+    @brief  feed one report, emitting the output points that are now fully determined
+*/
+void CST816S_Resampler::onTouchEvent(const touch_event &event)
+{
+    sample s = {event.timestamp, (float)event.x, (float)event.y};
+
+    if (event.event == 0 || (event.event == 2 && !_down))
+    {
+        _down = true;
+        _history[0] = s;
+        _count = 1;
+        emit(s.t, s.x, s.y, 0);
+        _next = s.t + _period_us;
+        return;
+    }
+    if (!_down)
+    {
+        return;
+    }
+
+    const sample &last = _history[_count - 1];
+    if (s.t == last.t)
+    {
+        // same instant, keep the newer position
+        _history[_count - 1] = s;
+    }
+    else if (s.t - last.t > _max_gap_us)
+    {
+        // do not spline across a long pause, end the chain and restart at this report
+        finish();
+        _history[0] = s;
+        _count = 1;
+        if ((int32_t)(_next - s.t) < 0)
+        {
+            _next = s.t;
+        }
+    }
+    else
+    {
+        append(s);
+    }
+
+    if (event.event == 1)
+    {
+        finish();
+        emit(_next, _history[_count - 1].x, _history[_count - 1].y, 1);
+        _down = false;
+    }
+}
+
+/*!
+    @brief  add a report and emit the segment it completes
+*/
+void CST816S_Resampler::append(const sample &s)
+{
+    if (_count == 1)
+    {
+        _history[1] = s;
+        _count = 2;
+        return;
+    }
+    if (_count == 2)
+    {
+        // first segment of a chain, mirror its start to get the tangent
+        segment(mirror(_history[0], _history[1]), _history[0], _history[1], s);
+        _history[2] = s;
+        _count = 3;
+        return;
+    }
+    segment(_history[0], _history[1], _history[2], s);
+    _history[0] = _history[1];
+    _history[1] = _history[2];
+    _history[2] = s;
+}
+
+/*!
+    @brief  emit the last segment of a chain, mirroring its end for the missing next report
+*/
+void CST816S_Resampler::finish()
+{
+    if (_count == 2)
+    {
+        segment(mirror(_history[0], _history[1]), _history[0], _history[1], mirror(_history[1], _history[0]));
+    }
+    else if (_count == 3)
+    {
+        segment(_history[0], _history[1], _history[2], mirror(_history[2], _history[1]));
+    }
+    _history[0] = _history[_count - 1];
+    _count = 1;
+}
+
+/*!
+    @brief  emit the output points in [p1.t, p2.t) on the non-uniform Catmull-Rom spline p0-p3
+*/
+void CST816S_Resampler::segment(const sample &p0, const sample &p1, const sample &p2, const sample &p3)
+{
+    // knots relative to p1, Barry-Goldman pyramid
+    float t0 = (float)(int32_t)(p0.t - p1.t);
+    float t2 = (float)(int32_t)(p2.t - p1.t);
+    float t3 = (float)(int32_t)(p3.t - p1.t);
+    if (t0 >= 0 || t2 <= 0 || t3 <= t2)
+    {
+        return;
+    }
+
+    while ((int32_t)(p2.t - _next) > 0)
+    {
+        float t = (float)(int32_t)(_next - p1.t);
+
+        float a1 = (0 - t) / (0 - t0), b1 = (t - t0) / (0 - t0);
+        float a2 = (t2 - t) / t2, b2 = t / t2;
+        float a3 = (t3 - t) / (t3 - t2), b3 = (t - t2) / (t3 - t2);
+        float A1x = a1 * p0.x + b1 * p1.x, A1y = a1 * p0.y + b1 * p1.y;
+        float A2x = a2 * p1.x + b2 * p2.x, A2y = a2 * p1.y + b2 * p2.y;
+        float A3x = a3 * p2.x + b3 * p3.x, A3y = a3 * p2.y + b3 * p3.y;
+
+        float c1 = (t2 - t) / (t2 - t0), d1 = (t - t0) / (t2 - t0);
+        float c2 = (t3 - t) / t3, d2 = t / t3;
+        float B1x = c1 * A1x + d1 * A2x, B1y = c1 * A1y + d1 * A2y;
+        float B2x = c2 * A2x + d2 * A3x, B2y = c2 * A2y + d2 * A3y;
+
+        emit(_next, a2 * B1x + b2 * B2x, a2 * B1y + b2 * B2y, 2);
+        _next += _period_us;
+    }
+}
+
+/*!
+    @brief  reflection of from about at, in time and space
+*/
+CST816S_Resampler::sample CST816S_Resampler::mirror(const sample &at, const sample &from)
+{
+    sample s = {at.t + (at.t - from.t), 2 * at.x - from.x, 2 * at.y - from.y};
+    return s;
+}
+
+void CST816S_Resampler::emit(uint32_t t, float x, float y, uint8_t event)
+{
+    if ((uint8_t)(_head - _tail) == CST816S_RESAMPLE_QUEUE)
+    {
+        _tail++; // keep the newest points, the reader fell behind
+        _dropped++;
+    }
+    resampled_point &point = _queue[_head++ & (CST816S_RESAMPLE_QUEUE - 1)];
+    point.timestamp = t;
+    point.x = x;
+    point.y = y;
+    point.event = event;
+}
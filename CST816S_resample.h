@@ -0,0 +1,96 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_RESAMPLE_H
+#define CST816S_RESAMPLE_H
+
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+// Resampled points buffered until read(), must be a power of two of at most 128
+#ifndef CST816S_RESAMPLE_QUEUE
+#define CST816S_RESAMPLE_QUEUE 32
+#endif
+
+struct resampled_point
+{
+    uint32_t timestamp; // on the output grid, in us
+    float x;
+    float y;
+    uint8_t event;      // 0 = first point of a stroke, 1 = last, 2 = in between
+};
+
+/*
+    Converts the irregularly timed touch reports of a stroke into points at a
+    fixed rate. Between reports the position is interpolated with a
+    Catmull-Rom spline that uses the report times as knots, so uneven report
+    intervals do not bend the curve. A segment is emitted once the report
+    after it arrives, which delays output by at most two report intervals;
+    reports further apart than maxGapMs are not splined across but start a
+    new segment chain.
+*/
+class CST816S_Resampler : public CST816S_Sink
+{
+    public:
+        CST816S_Resampler(uint16_t rateHz = 120, uint16_t maxGapMs = 50);
+
+        void onTouchEvent(const touch_event &event) override;
+
+        bool read(resampled_point &point);
+        uint8_t available() const { return (uint8_t)(_head - _tail); }
+        uint32_t dropped() const { return _dropped; }
+
+    private:
+        // the 8-bit head and tail must tell a full queue from an empty one
+        static_assert(CST816S_RESAMPLE_QUEUE > 0 && (CST816S_RESAMPLE_QUEUE & (CST816S_RESAMPLE_QUEUE - 1)) == 0 &&
+                          CST816S_RESAMPLE_QUEUE <= 128,
+                      "CST816S_RESAMPLE_QUEUE must be a power of two of at most 128");
+
+        struct sample
+        {
+            uint32_t t;
+            float x;
+            float y;
+        };
+
+        uint32_t _period_us;
+        uint32_t _max_gap_us;
+        bool _down = false;
+        sample _history[3];     // last reports, oldest first
+        uint8_t _count = 0;
+        uint32_t _next;         // time of the next output point
+        resampled_point _queue[CST816S_RESAMPLE_QUEUE];
+        uint8_t _head = 0;
+        uint8_t _tail = 0;
+        uint32_t _dropped = 0;
+
+        void append(const sample &s);
+        void finish();
+        void segment(const sample &p0, const sample &p1, const sample &p2, const sample &p3);
+        void emit(uint32_t t, float x, float y, uint8_t event);
+        static sample mirror(const sample &at, const sample &from);
+};
+
+#endif
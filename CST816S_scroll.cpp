@@ -0,0 +1,261 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "CST816S_scroll.h"
+
+// Below this speed (pixels per tick) a fling ends, and within this distance a settle ends
+#define SCROLL_STOP CST816S_Q16(0.125)
+// Share of the remaining distance covered per tick while settling
+#define SCROLL_SPRING CST816S_Q16(0.25)
+// Share of the velocity kept per tick while flinging into the overscroll area
+#define SCROLL_BRAKE CST816S_Q16(0.5)
+// Gaps between reports longer than this mean the finger rested, the velocity restarts
+#define SCROLL_REST_US 100000
+
+static inline q16_16 q16_mul(q16_16 a, q16_16 b)
+{
+    return (q16_16)(((int64_t)a * b) >> 16);
+}
+
+static inline q32_16 q32_mul(q32_16 a, q16_16 b)
+{
+    return (a * b) >> 16;
+}
+
+static inline q32_16 q32_abs(q32_16 a)
+{
+    return a < 0 ? -a : a;
+}
+
+/*!
+    @brief  Constructor for CST816S_Scroll
+*/
+CST816S_Scroll::CST816S_Scroll(int32_t contentLength, int32_t viewLength, bool vertical, uint16_t tickMs)
+{
+    _vertical = vertical;
+    _tick_us = (uint32_t)tickMs * 1000;
+    _view = viewLength;
+    _overscroll = CST816S_Q32(viewLength / 4);
+    _max = CST816S_Q32(contentLength > viewLength ? contentLength - viewLength : 0);
+}
+
+/*!
+    @brief  change the content length, e.g. when items are added, keeping the offset in range
+*/
+void CST816S_Scroll::setContentLength(int32_t contentLength)
+{
+    _max = CST816S_Q32(contentLength > _view ? contentLength - _view : 0);
+    if (_state != SCROLL_DRAG && _pos > _max)
+    {
+        _target = _page ? snap(_max) : _max;
+        _state = SCROLL_SETTLE;
+    }
+}
+
+/*!
+    @brief  jump to an offset in pixels, stopping any motion
+*/
+void CST816S_Scroll::scrollTo(int32_t offset)
+{
+    _pos = CST816S_Q32(offset);
+    if (_pos < 0)
+    {
+        _pos = 0;
+    }
+    else if (_pos > _max)
+    {
+        _pos = _max;
+    }
+    _velocity = 0;
+    _state = SCROLL_IDLE;
+}
+
+/*!
+    @brief  follow the finger while it is down and start the fling when it is lifted
+*/
+void CST816S_Scroll::onTouchEvent(const touch_event &event)
+{
+    int coord = _vertical ? event.y : event.x;
+
+    if (event.event == 0 || (event.event == 2 && _state != SCROLL_DRAG))
+    {
+        // down, also catches a running fling or settle
+        _state = SCROLL_DRAG;
+        _drag_pos = _pos;
+        _drag_start = coord;
+        _last_coord = coord;
+        _last_time = event.timestamp;
+        _velocity = 0;
+        return;
+    }
+    if (_state != SCROLL_DRAG)
+    {
+        return;
+    }
+
+    // moving the finger towards 0 moves the content forward
+    _pos = rubber_band(_drag_pos + CST816S_Q32(_drag_start - coord));
+
+    uint32_t dt = event.timestamp - _last_time;
+    if (dt > SCROLL_REST_US)
+    {
+        _velocity = 0;
+    }
+    else if (coord != _last_coord && dt > 0)
+    {
+        // distance per tick of this sample, smoothed over the last few reports
+        q16_16 sample = (q16_16)(((int64_t)CST816S_Q16(_last_coord - coord) * _tick_us) / dt);
+        _velocity += (sample - _velocity) / 2;
+    }
+    _last_coord = coord;
+    _last_time = event.timestamp;
+
+    if (event.event == 1)
+    {
+        release();
+    }
+}
+
+/*!
+    @brief  advance the animation by one frame
+    @return true while the offset is still changing
+*/
+bool CST816S_Scroll::tick()
+{
+    switch (_state)
+    {
+    case SCROLL_FLING:
+        _pos += _velocity;
+        if (_pos < 0 || _pos > _max)
+        {
+            // brake hard past the edge, then spring back to it
+            q32_16 edge = _pos < 0 ? 0 : _max;
+            _velocity = q16_mul(_velocity, SCROLL_BRAKE);
+            _pos = rubber_band(_pos);
+            if (q32_abs(_velocity) < SCROLL_STOP || q32_abs(_pos - edge) >= _overscroll)
+            {
+                _velocity = 0;
+                _target = edge;
+                _state = SCROLL_SETTLE;
+            }
+            return true;
+        }
+        _velocity = q16_mul(_velocity, _friction);
+        if (q32_abs(_velocity) < SCROLL_STOP)
+        {
+            _velocity = 0;
+            _state = SCROLL_IDLE;
+        }
+        return true;
+
+    case SCROLL_SETTLE:
+    {
+        q32_16 distance = _target - _pos;
+        if (q32_abs(distance) < SCROLL_STOP)
+        {
+            _pos = _target;
+            _state = SCROLL_IDLE;
+            return true;
+        }
+        _pos += q32_mul(distance, SCROLL_SPRING);
+        return true;
+    }
+
+    case SCROLL_DRAG:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/*!
+    @brief  choose how to continue once the finger is lifted
+*/
+void CST816S_Scroll::release()
+{
+    if (_page)
+    {
+        // snap to the page the fling would have coasted to, at most one page from the start
+        q32_16 coast = ((q32_16)_velocity * 65536) / (65536 - _friction);
+        q32_16 target = snap(_pos + coast);
+        q32_16 start = snap(_drag_pos);
+        if (target > start + _page)
+        {
+            target = start + _page;
+        }
+        else if (target < start - _page)
+        {
+            target = start - _page;
+        }
+        _target = target;
+        _velocity = 0;
+        _state = SCROLL_SETTLE;
+    }
+    else if (_pos < 0 || _pos > _max)
+    {
+        _target = _pos < 0 ? 0 : _max;
+        _velocity = 0;
+        _state = SCROLL_SETTLE;
+    }
+    else
+    {
+        _state = q32_abs(_velocity) < SCROLL_STOP ? SCROLL_IDLE : SCROLL_FLING;
+    }
+}
+
+/*!
+    @brief  resistance past the ends: half of the excess, at most a quarter of the view
+*/
+q32_16 CST816S_Scroll::rubber_band(q32_16 pos) const
+{
+    if (pos < 0)
+    {
+        q32_16 excess = -pos / 2;
+        return excess < _overscroll ? -excess : -_overscroll;
+    }
+    if (pos > _max)
+    {
+        q32_16 excess = (pos - _max) / 2;
+        return _max + (excess < _overscroll ? excess : _overscroll);
+    }
+    return pos;
+}
+
+/*!
+    @brief  nearest page boundary inside the content
+*/
+q32_16 CST816S_Scroll::snap(q32_16 pos) const
+{
+    if (pos <= 0)
+    {
+        return 0;
+    }
+    if (pos >= _max)
+    {
+        pos = _max;
+    }
+    q32_16 page = ((pos + _page / 2) / _page) * _page;
+    return page > _max ? _max : page;
+}
@@ -0,0 +1,100 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_SCROLL_H
+#define CST816S_SCROLL_H
+
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+// Q16.16 fixed point: 16 integer bits (pixels), 16 fraction bits, for velocities and factors
+typedef int32_t q16_16;
+#define CST816S_Q16(x) ((q16_16)((x) * 65536))
+// Q32.16 for offsets, so content longer than 32767 pixels does not overflow
+typedef int64_t q32_16;
+#define CST816S_Q32(x) ((q32_16)(x) * 65536)
+
+enum SCROLL_STATE
+{
+    SCROLL_IDLE = 0,
+    SCROLL_DRAG = 1,    // following the finger
+    SCROLL_FLING = 2,   // coasting with friction after release
+    SCROLL_SETTLE = 3   // springing back from overscroll or to a page
+};
+
+/*
+    Kinetic scrolling along one axis, driven by the down/contact/up events of
+    the driver and advanced with tick() once per display frame. Integer only,
+    every tick costs the same few multiplications regardless of the state.
+    The offset runs from 0 to contentLength - viewLength and may leave that
+    range by up to a quarter of the view while overscrolling.
+*/
+class CST816S_Scroll : public CST816S_Sink
+{
+    public:
+        /*!
+            @param  contentLength  length of the scrolled content in pixels
+            @param  viewLength  visible length in pixels
+            @param  vertical  scroll along y, else along x
+            @param  tickMs  frame period at which tick() is called
+        */
+        CST816S_Scroll(int32_t contentLength, int32_t viewLength, bool vertical = true, uint16_t tickMs = 16);
+
+        void onTouchEvent(const touch_event &event) override;
+
+        bool tick();
+        void scrollTo(int32_t offset);
+        void setContentLength(int32_t contentLength);
+        void setPageSize(int32_t pageSize) { _page = CST816S_Q32(pageSize); }
+        void setFriction(uint16_t friction) { _friction = friction; }
+
+        int32_t offset() const { return (int32_t)(_pos >> 16); }
+        q32_16 offsetQ16() const { return _pos; }
+        q16_16 velocity() const { return _velocity; }
+        uint8_t state() const { return _state; }
+
+    private:
+        bool _vertical;
+        uint32_t _tick_us;
+        int32_t _view;
+        q32_16 _max;               // largest offset inside the content
+        q32_16 _overscroll;        // furthest the offset may leave [0, _max]
+        q32_16 _page = 0;          // snap distance, 0 = no snapping
+        uint16_t _friction = 62259; // Q0.16 share of the velocity kept per tick, 0.95
+        uint8_t _state = SCROLL_IDLE;
+        q32_16 _pos = 0;
+        q16_16 _velocity = 0;      // pixels per tick
+        q32_16 _target = 0;        // of SCROLL_SETTLE
+        q32_16 _drag_pos;          // offset when the finger went down
+        int _drag_start;           // finger coordinate when it went down
+        int _last_coord;
+        uint32_t _last_time;
+
+        q32_16 rubber_band(q32_16 pos) const;
+        q32_16 snap(q32_16 pos) const;
+        void release();
+};
+
+#endif
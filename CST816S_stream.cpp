@@ -0,0 +1,310 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "CST816S_stream.h"
+
+#include <string.h>
+
+/*!
+    @brief  CRC-16/CCITT-FALSE, start with 0xFFFF
+*/
+uint16_t cst816s_stream_crc(uint16_t crc, const uint8_t *data, size_t length)
+{
+    while (length--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+        for (int i = 0; i < 8; i++)
+        {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint8_t *put_varint(uint8_t *p, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *p++ = value | 0x80;
+        value >>= 7;
+    }
+    *p++ = value;
+    return p;
+}
+
+static uint8_t *put_zigzag(uint8_t *p, int32_t value)
+{
+    return put_varint(p, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+static bool get_varint(const uint8_t *&p, const uint8_t *end, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        uint8_t b = *p++;
+        value |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool get_zigzag(const uint8_t *&p, const uint8_t *end, int32_t &value)
+{
+    uint32_t raw;
+    if (!get_varint(p, end, raw))
+    {
+        return false;
+    }
+    value = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+    return true;
+}
+
+/*!
+    @brief  Constructor for CST816S_StreamEncoder
+*/
+CST816S_StreamEncoder::CST816S_StreamEncoder(stream_write write, void *arg, uint8_t batch)
+{
+    _write = write;
+    _arg = arg;
+    _batch = batch > 0 ? batch : 1;
+}
+
+/*!
+    @brief  add an event to the current frame, sending it when the batch is complete
+*/
+void CST816S_StreamEncoder::encode(const touch_event &event)
+{
+    if (_length + CST816S_STREAM_MAX_EVENT > CST816S_STREAM_MAX_PAYLOAD)
+    {
+        flush();
+    }
+
+    uint8_t *start = _frame + 2 + _length;
+    uint8_t *p = start + 1;
+    uint8_t points = event.points > 3 ? 3 : event.points;
+    uint8_t flags = (event.event & 0x03) | (points << 2);
+    bool first = _count == 0;
+    if (first ? event.gestureID != NONE : event.gestureID != _previous.gestureID)
+    {
+        flags |= 0x10;
+        *p++ = event.gestureID;
+    }
+    if (first)
+    {
+        p = put_varint(p, event.timestamp);
+        p = put_zigzag(p, event.x);
+        p = put_zigzag(p, event.y);
+    }
+    else
+    {
+        p = put_varint(p, event.timestamp - _previous.timestamp);
+        p = put_zigzag(p, event.x - _previous.x);
+        p = put_zigzag(p, event.y - _previous.y);
+    }
+    *start = flags;
+
+    _length += p - start;
+    _previous = event;
+    _events++;
+    if (++_count >= _batch)
+    {
+        flush();
+    }
+}
+
+/*!
+    @brief  send the events collected so far as one frame
+*/
+void CST816S_StreamEncoder::flush()
+{
+    if (_count == 0)
+    {
+        return;
+    }
+
+    _frame[0] = CST816S_STREAM_SYNC;
+    _frame[1] = _length;
+    uint16_t crc = cst816s_stream_crc(0xFFFF, _frame + 1, _length + 1);
+    _frame[2 + _length] = crc;
+    _frame[3 + _length] = crc >> 8;
+    _write(_frame, _length + 4, _arg);
+
+    _bytes += _length + 4;
+    _length = 0;
+    _count = 0;
+}
+
+/*!
+    @brief  Constructor for CST816S_StreamDecoder
+*/
+CST816S_StreamDecoder::CST816S_StreamDecoder(stream_event event, void *arg)
+{
+    _event = event;
+    _arg = arg;
+}
+
+/*!
+    @brief  consume received bytes, decoded events are passed to the event callback
+*/
+void CST816S_StreamDecoder::feed(const uint8_t *data, size_t length)
+{
+    while (length > 0)
+    {
+        size_t n = sizeof(_buffer) - _length;
+        n = n < length ? n : length;
+        memcpy(_buffer + _length, data, n);
+        _length += n;
+        data += n;
+        length -= n;
+
+        // a full buffer always holds a complete frame, so parse() makes room before the next copy
+        size_t used = parse();
+        _length -= used;
+        memmove(_buffer, _buffer + used, _length);
+    }
+}
+
+/*!
+    @brief  true if a complete frame with a matching CRC starts at pos
+*/
+bool CST816S_StreamDecoder::valid_frame(size_t pos) const
+{
+    if (_length - pos < 2)
+    {
+        return false; // the length byte has not arrived, and may lie past the buffer
+    }
+    const uint8_t *frame = _buffer + pos;
+    size_t payload = frame[1];
+    if (payload == 0 || _length - pos < payload + 4)
+    {
+        return false;
+    }
+    uint16_t crc = cst816s_stream_crc(0xFFFF, frame + 1, payload + 1);
+    return crc == (frame[2 + payload] | (frame[3 + payload] << 8));
+}
+
+/*!
+    @brief  decode the complete frames in the buffer
+    @return number of bytes consumed, the rest starts at a sync byte and waits for more data
+*/
+size_t CST816S_StreamDecoder::parse()
+{
+    size_t pos = 0;
+    for (;;)
+    {
+        const uint8_t *sync = (const uint8_t *)memchr(_buffer + pos, CST816S_STREAM_SYNC, _length - pos);
+        if (sync == nullptr)
+        {
+            return _length;
+        }
+        pos = sync - _buffer;
+        if (_length - pos < 2)
+        {
+            return pos;
+        }
+        size_t payload = _buffer[pos + 1];
+        if (_length - pos >= payload + 4 || payload == 0)
+        {
+            if (valid_frame(pos))
+            {
+                _frames++;
+                decode_payload(_buffer + pos + 2, payload);
+                pos += payload + 4;
+            }
+            else
+            {
+                // the sync or length byte may have been corrupted, resume at the next byte
+                _crc_errors++;
+                pos++;
+            }
+            continue;
+        }
+
+        // incomplete, unless a valid frame follows: then this sync byte was noise and
+        // waiting for its claimed length would hold back the frames behind it
+        size_t next = pos + 1;
+        for (;;)
+        {
+            sync = (const uint8_t *)memchr(_buffer + next, CST816S_STREAM_SYNC, _length - next);
+            if (sync == nullptr || valid_frame(sync - _buffer))
+            {
+                break;
+            }
+            next = sync - _buffer + 1;
+        }
+        if (sync == nullptr)
+        {
+            return pos;
+        }
+        _crc_errors++;
+        pos = sync - _buffer;
+    }
+}
+
+void CST816S_StreamDecoder::decode_payload(const uint8_t *payload, size_t length)
+{
+    const uint8_t *p = payload;
+    const uint8_t *end = payload + length;
+    touch_event event = {};
+    bool first = true;
+    while (p < end)
+    {
+        uint8_t flags = *p++;
+        event.event = flags & 0x03;
+        event.points = (flags >> 2) & 0x03;
+        if (flags & 0x10)
+        {
+            if (p >= end)
+            {
+                return;
+            }
+            event.gestureID = *p++;
+        }
+
+        uint32_t time;
+        int32_t x, y;
+        if (!get_varint(p, end, time) || !get_zigzag(p, end, x) || !get_zigzag(p, end, y))
+        {
+            return;
+        }
+        if (first)
+        {
+            event.timestamp = time;
+            event.x = x;
+            event.y = y;
+            first = false;
+        }
+        else
+        {
+            event.timestamp += time;
+            event.x += x;
+            event.y += y;
+        }
+        _event(event, _arg);
+    }
+}
@@ -0,0 +1,121 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_STREAM_H
+#define CST816S_STREAM_H
+
+/*
+    Compact framed binary protocol for mirroring touch events over UART, BLE
+    or any byte stream. Encoder and decoder have no Arduino dependencies so
+    the same code runs on the device and on the host.
+
+    frame:   0xC8, payload length (1 byte), payload, CRC-16/CCITT-FALSE of
+             length and payload (2 bytes, little-endian)
+    payload: one or more events, each
+             flags   bits 0-1 event, bits 2-3 points (clamped to 3),
+                     bit 4 gesture byte follows
+             gesture gestureID, only when it differs from the previous event
+             time    varint, absolute timestamp for the first event of the
+                     frame, otherwise microseconds since the previous event
+             x, y    zigzag varints, absolute for the first event of the
+                     frame, otherwise the difference to the previous event
+
+    Frames are independent, so a corrupted frame loses only its own events.
+    After a CRC error the decoder searches for the next sync byte from the
+    byte after the rejected one, and it does not wait for the claimed length
+    of a frame when a valid frame already follows it, so a corrupted length
+    byte cannot swallow or hold back the frames behind it.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CST816S_decode.h"
+
+#define CST816S_STREAM_SYNC 0xC8
+#define CST816S_STREAM_MAX_PAYLOAD 255
+#define CST816S_STREAM_MAX_EVENT 17 // flags, gesture, 5 byte time, 2 * 5 byte coordinate
+
+typedef void (*stream_write)(const uint8_t *data, size_t length, void *arg);
+typedef void (*stream_event)(const touch_event &event, void *arg);
+
+class CST816S_StreamEncoder : public CST816S_Sink
+{
+    public:
+        /*!
+            @param  write  receives each complete frame
+            @param  arg  passed unchanged to write
+            @param  batch  events collected before a frame is sent, 1 sends every event immediately
+        */
+        CST816S_StreamEncoder(stream_write write, void *arg = nullptr, uint8_t batch = 8);
+
+        void onTouchEvent(const touch_event &event) override { encode(event); }
+        void encode(const touch_event &event);
+        void flush();
+
+        uint32_t bytesSent() const { return _bytes; }
+        uint32_t eventsSent() const { return _events; }
+
+    private:
+        stream_write _write;
+        void *_arg;
+        uint8_t _batch;
+        uint8_t _count = 0;
+        uint8_t _frame[2 + CST816S_STREAM_MAX_PAYLOAD + 2];
+        size_t _length = 0;
+        touch_event _previous;
+        uint32_t _bytes = 0;
+        uint32_t _events = 0;
+};
+
+class CST816S_StreamDecoder
+{
+    public:
+        /*!
+            @param  event  receives each decoded event
+            @param  arg  passed unchanged to event
+        */
+        CST816S_StreamDecoder(stream_event event, void *arg = nullptr);
+
+        void feed(const uint8_t *data, size_t length);
+
+        uint32_t frames() const { return _frames; }
+        uint32_t crcErrors() const { return _crc_errors; }
+
+    private:
+        stream_event _event;
+        void *_arg;
+        uint8_t _buffer[2 + CST816S_STREAM_MAX_PAYLOAD + 2]; // at most one frame, starting at a sync byte
+        size_t _length = 0;
+        uint32_t _frames = 0;
+        uint32_t _crc_errors = 0;
+
+        size_t parse();
+        bool valid_frame(size_t pos) const;
+        void decode_payload(const uint8_t *payload, size_t length);
+};
+
+uint16_t cst816s_stream_crc(uint16_t crc, const uint8_t *data, size_t length);
+
+#endif
@@ -0,0 +1,121 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_TRACE_H
+#define CST816S_TRACE_H
+
+/*
+    Binary touch trace format
+
+    A trace file is a trace_header followed by fixed size trace_record
+    entries, all fields little-endian. Records hold the report frame exactly
+    as read from register 0x01, so recorded traces are decoded with the same
+    cst816s_decode() the driver uses and can be memory-mapped and split at
+    any record boundary.
+
+    offset  size  header field
+    0       4     magic "C816"
+    4       2     version (1)
+    6       2     record size (12)
+    8       2     panel width
+    10      2     panel height
+    12      1     rotation (0-3) applied when decoding
+    13      3     reserved, zero
+
+    offset  size  record field
+    0       4     timestamp in microseconds at the report interrupt, wraps after ~71 minutes
+    4       6     report frame: gesture, points, XH, XL, YH, YL
+    10      1     flags (CST816S_TRACE_FLAG_*)
+    11      1     reserved, zero
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "CST816S_decode.h"
+
+#define CST816S_TRACE_MAGIC 0x36313843UL // "C816"
+#define CST816S_TRACE_VERSION 1
+
+#define CST816S_TRACE_FLAG_ERROR 0x01    // frame could not be read, contents undefined
+
+struct __attribute__((packed)) trace_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint16_t width;
+    uint16_t height;
+    uint8_t rotation;
+    uint8_t reserved[3];
+};
+
+struct __attribute__((packed)) trace_record
+{
+    uint32_t timestamp;
+    uint8_t frame[6];
+    uint8_t flags;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(trace_header) == 16, "trace_header layout");
+static_assert(sizeof(trace_record) == 12, "trace_record layout");
+
+/*!
+    @brief  fill a trace header
+*/
+static inline void cst816s_trace_header(trace_header &header, int width, int height, int rotation)
+{
+    memset(&header, 0, sizeof(header));
+    header.magic = CST816S_TRACE_MAGIC;
+    header.version = CST816S_TRACE_VERSION;
+    header.recordSize = sizeof(trace_record);
+    header.width = width;
+    header.height = height;
+    header.rotation = rotation;
+}
+
+/*!
+    @brief  fill a trace record from a report frame
+*/
+static inline void cst816s_trace_record(trace_record &record, uint32_t timestamp, const uint8_t *frame, uint8_t flags)
+{
+    record.timestamp = timestamp;
+    memcpy(record.frame, frame, sizeof(record.frame));
+    record.flags = flags;
+    record.reserved = 0;
+}
+
+/*!
+    @brief  decode a trace record with the rotation stored in the header
+*/
+static inline void cst816s_trace_decode(const trace_header &header, const trace_record &record, touch_event &event)
+{
+    cst816s_decode(record.frame, event);
+    event.timestamp = record.timestamp;
+    event.gestureID = cst816s_rotate_gesture(event.gestureID, header.rotation);
+    cst816s_rotate_point(event.x, event.y, header.rotation, header.width, header.height);
+}
+
+#endif
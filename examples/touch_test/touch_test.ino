@@ -31,6 +31,8 @@ void setup() {
 
   touch.begin();
 
+  Serial.print(touch.chip().name);
+  Serial.print("\t");
   Serial.print(touch.data.version);
   Serial.print("\t");
   Serial.print(touch.data.versionInfo[0]);
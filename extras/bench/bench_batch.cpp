@@ -0,0 +1,98 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// Batch decoder throughput in frames per second (items_per_second), against the per-frame decoder
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "CST816S_batch.h"
+#include "CST816S_decode.h"
+
+#define BATCH_FRAMES 4096
+
+static std::vector<uint8_t> make_frames(size_t count)
+{
+    std::vector<uint8_t> frames(count * 6);
+    uint32_t state = 12345;
+    for (auto &b : frames)
+    {
+        state = state * 1664525 + 1013904223;
+        b = state >> 24;
+    }
+    return frames;
+}
+
+struct batch_buffers
+{
+    std::vector<uint8_t> gestureID, points, event;
+    std::vector<int16_t> x, y;
+    batch_events out;
+
+    batch_buffers(size_t count) : gestureID(count), points(count), event(count), x(count), y(count)
+    {
+        out = {gestureID.data(), points.data(), event.data(), x.data(), y.data()};
+    }
+};
+
+static void BM_DecodeBatch(benchmark::State &state)
+{
+    int rotation = state.range(0);
+    std::vector<uint8_t> frames = make_frames(BATCH_FRAMES);
+    batch_buffers buffers(BATCH_FRAMES);
+    for (auto _ : state)
+    {
+        cst816s_decode_batch(frames.data(), BATCH_FRAMES, rotation, 240, 280, buffers.out);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_FRAMES);
+    state.SetLabel(cst816s_decode_batch_impl());
+}
+BENCHMARK(BM_DecodeBatch)->DenseRange(0, 3);
+
+// the same work one frame at a time, as read_touch() does it
+static void BM_DecodeFrames(benchmark::State &state)
+{
+    int rotation = state.range(0);
+    std::vector<uint8_t> frames = make_frames(BATCH_FRAMES);
+    batch_buffers buffers(BATCH_FRAMES);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < BATCH_FRAMES; i++)
+        {
+            touch_event event;
+            cst816s_decode(frames.data() + i * 6, event);
+            cst816s_rotate_point(event.x, event.y, rotation, 240, 280);
+            buffers.gestureID[i] = cst816s_rotate_gesture(event.gestureID, rotation);
+            buffers.points[i] = event.points;
+            buffers.event[i] = event.event;
+            buffers.x[i] = event.x;
+            buffers.y[i] = event.y;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_FRAMES);
+}
+BENCHMARK(BM_DecodeFrames)->DenseRange(0, 3);
@@ -0,0 +1,98 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// Broadcast publish cost with a number of subscriber threads reading concurrently (the argument), and
+// the share of events each subscriber read rather than lost because it fell behind
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "CST816S_broadcast.h"
+
+static void BM_BroadcastReaders(benchmark::State &state)
+{
+    const int readers = state.range(0);
+    CST816S_Broadcast bus;
+    std::atomic<bool> stop{false};
+    std::vector<CST816S_Broadcast::Subscriber *> subs;
+    std::vector<uint32_t> read(readers, 0);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; r++)
+    {
+        subs.push_back(new CST816S_Broadcast::Subscriber(bus));
+    }
+    for (int r = 0; r < readers; r++)
+    {
+        threads.emplace_back([&, r] {
+            touch_event e;
+            uint32_t n = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (subs[r]->read(e))
+                {
+                    benchmark::DoNotOptimize(e);
+                    n++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            read[r] = n;
+        });
+    }
+
+    touch_event e = {};
+    e.event = 2;
+    for (auto _ : state)
+    {
+        e.timestamp++;
+        e.x = e.timestamp & 0xFF;
+        bus.publish(e);
+    }
+    stop = true;
+    for (std::thread &t : threads)
+    {
+        t.join();
+    }
+
+    uint64_t reads = 0;
+    uint64_t lost = 0;
+    for (int r = 0; r < readers; r++)
+    {
+        reads += read[r];
+        lost += subs[r]->lost();
+        delete subs[r];
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (readers > 0)
+    {
+        state.counters["read_share"] = (double)reads / (reads + lost);
+        state.counters["reads_per_second"] = benchmark::Counter((double)reads, benchmark::Counter::kIsRate);
+    }
+}
+BENCHMARK(BM_BroadcastReaders)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
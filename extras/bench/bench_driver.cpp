@@ -0,0 +1,184 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/*
+    Hot paths of the driver: report decode through a simulated bus, rotation,
+    gesture names, the event queue and the whole pipeline from interrupt to
+    readEvent(). Export the results for comparison between releases with
+        cst816s-bench --benchmark_format=json > bench.json
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+
+#define PIN_SDA 4
+#define PIN_SCL 5
+#define PIN_RST 6
+#define PIN_IRQ 7
+
+class CountingSink : public CST816S_Sink
+{
+    public:
+        void onTouchEvent(const touch_event &event) override
+        {
+            events++;
+            benchmark::DoNotOptimize(event.x);
+        }
+        uint64_t events = 0;
+};
+
+// report decode without queueing or dispatching: the event mask drops every event after publish()
+static void BM_ReadTouch(benchmark::State &state)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.begin();
+    touch.setEventMask(0);
+    sim.report(2, 120, 200);
+    for (auto _ : state)
+    {
+        host_interrupt(PIN_IRQ);
+        touch.available();
+        benchmark::DoNotOptimize(touch.data.x);
+    }
+}
+BENCHMARK(BM_ReadTouch);
+
+// decode, rotation and publish of a frame that does not come from the bus
+static void BM_Inject(benchmark::State &state)
+{
+    host_reset();
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ, 1);
+    const uint8_t frame[6] = {SWIPE_UP, 1, 0x80, 120, 0x00, 200};
+    uint32_t timestamp = 0;
+    touch_event event;
+    for (auto _ : state)
+    {
+        touch.inject(frame, timestamp += 10000);
+        touch.readEvent(event);
+    }
+    benchmark::DoNotOptimize(event);
+}
+BENCHMARK(BM_Inject);
+
+static void BM_RotatePoint(benchmark::State &state)
+{
+    int rotation = state.range(0);
+    int x = 37, y = 211;
+    for (auto _ : state)
+    {
+        cst816s_rotate_point(x, y, rotation, 240, 240);
+        benchmark::DoNotOptimize(x);
+        benchmark::DoNotOptimize(y);
+    }
+}
+BENCHMARK(BM_RotatePoint)->DenseRange(0, 3);
+
+static void BM_RotateGesture(benchmark::State &state)
+{
+    int rotation = state.range(0);
+    uint8_t gesture = SWIPE_UP;
+    for (auto _ : state)
+    {
+        gesture = cst816s_rotate_gesture(gesture, rotation);
+        benchmark::DoNotOptimize(gesture);
+    }
+}
+BENCHMARK(BM_RotateGesture)->DenseRange(0, 3);
+
+static void BM_Gesture(benchmark::State &state)
+{
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.data.gestureID = SWIPE_LEFT;
+    for (auto _ : state)
+    {
+        String name = touch.gesture();
+        benchmark::DoNotOptimize(name.c_str());
+    }
+}
+BENCHMARK(BM_Gesture);
+
+static void BM_QueuePushPop(benchmark::State &state)
+{
+    CST816S_EventQueue queue;
+    touch_event event = {};
+    for (auto _ : state)
+    {
+        queue.push(event, CST816S_EVENT_MOVE);
+        queue.pop(event);
+        benchmark::DoNotOptimize(event);
+    }
+}
+BENCHMARK(BM_QueuePushPop);
+
+// fill the queue to the given depth, then drain it
+static void BM_QueueBurst(benchmark::State &state)
+{
+    CST816S_EventQueue queue;
+    int depth = state.range(0);
+    touch_event event = {};
+    for (auto _ : state)
+    {
+        for (int i = 0; i < depth; i++)
+        {
+            event.x = i;
+            queue.push(event, CST816S_EVENT_MOVE);
+        }
+        while (queue.pop(event))
+        {
+            benchmark::DoNotOptimize(event);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_QueueBurst)->Arg(4)->Arg(CST816S_EVENT_QUEUE_SIZE);
+
+// interrupt, bus read, decode, queue, sink dispatch and readEvent(); items_per_second is events/s
+static void BM_EndToEnd(benchmark::State &state)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CountingSink sink;
+    touch.begin();
+    touch.addSink(&sink);
+    touch_event event;
+    int x = 0;
+    for (auto _ : state)
+    {
+        sim.report(2, x, 160);
+        x = (x + 1) & 0xFF;
+        touch.available();
+        touch.readEvent(event);
+        benchmark::DoNotOptimize(event);
+    }
+    state.SetItemsProcessed(sink.events);
+}
+BENCHMARK(BM_EndToEnd);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/*
+    Robustness against bus and controller faults. A finger drags across the
+    simulated controller at 100 reports per second while available() is
+    polled every millisecond; one fault from the script is injected at
+    300 ms. Times are virtual, so they are controller time including the
+    delays of a recovery, not host CPU time:
+
+    recovery_ms  from the fault to the first event delivered after it
+    lost         reports that never became an event
+    recoveries   bus and controller resets run by the driver
+    blocked_ms   longest single available() call
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+
+#define PIN_SDA 4
+#define PIN_SCL 5
+#define PIN_RST 6
+#define PIN_IRQ 7
+
+#define REPORT_US 10000 // contact report period of the controller
+#define POLL_US 1000    // available() polling period of the application
+#define FAULT_MS 300
+#define RUN_MS 1000
+
+struct fault_run
+{
+    double recoveryMs;
+    uint32_t lost;
+    uint32_t recoveries;
+    double blockedMs;
+};
+
+static fault_run run_fault(const char *script)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.begin();
+
+    uint64_t start = host_time();
+    uint64_t fault = start + FAULT_MS * 1000ULL;
+    uint64_t end = start + RUN_MS * 1000ULL;
+    uint64_t next_report = start;
+    uint64_t recovered = 0;
+    uint64_t blocked = 0;
+    uint32_t generated = 0;
+    uint32_t delivered = 0;
+    int x = 0;
+
+    sim.script(script);
+    while (host_time() < end)
+    {
+        // reports due while available() was blocked overwrite each other in the controller
+        while (next_report <= host_time())
+        {
+            sim.report(generated == 0 ? 0 : 2, x, 160);
+            x = (x + 1) % 240;
+            generated++;
+            next_report += REPORT_US;
+        }
+        sim.update();
+
+        uint64_t before = host_time();
+        touch.available();
+        if (host_time() - before > blocked)
+        {
+            blocked = host_time() - before;
+        }
+
+        touch_event event;
+        while (touch.readEvent(event))
+        {
+            delivered++;
+            if (recovered == 0 && host_time() >= fault)
+            {
+                recovered = host_time();
+            }
+        }
+        host_advance(POLL_US);
+    }
+
+    fault_run run;
+    run.recoveryMs = recovered > 0 ? (recovered - fault) / 1000.0 : RUN_MS - FAULT_MS;
+    run.lost = generated - delivered;
+    run.recoveries = touch.errors().recoveries;
+    run.blockedMs = blocked / 1000.0;
+    return run;
+}
+
+static const char *const fault_scripts[] = {
+    "",
+    "300 nack 1",
+    "300 nack 6",
+    "300 stuck 9",
+    "300 short 1",
+    "300 short 6",
+    "300 spurious 6",
+    "300 reset",
+};
+
+static void BM_FaultRecovery(benchmark::State &state)
+{
+    const char *script = fault_scripts[state.range(0)];
+    fault_run run = {};
+    for (auto _ : state)
+    {
+        run = run_fault(script);
+    }
+    state.SetLabel(*script ? script + 4 : "no fault");
+    state.counters["recovery_ms"] = run.recoveryMs;
+    state.counters["lost"] = run.lost;
+    state.counters["recoveries"] = run.recoveries;
+    state.counters["blocked_ms"] = run.blockedMs;
+}
+BENCHMARK(BM_FaultRecovery)->DenseRange(0, sizeof(fault_scripts) / sizeof(fault_scripts[0]) - 1)->Iterations(1);
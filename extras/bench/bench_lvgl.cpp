@@ -0,0 +1,216 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/*
+    Cost of an LVGL input device read of CST816S_LVGL, with LVGL running
+    headless (a display whose flush does nothing). Reads go through LVGL's
+    own read path, lv_indev_read() in v9 and the indev read timer callback
+    in v8, so LVGL calls the adapter again while it sets continue_reading
+    and processes each point as it would in lv_timer_handler(). Built when
+    the host build is configured with -DCST816S_LVGL_DIR=<LVGL source tree>
+    or -DCST816S_FETCH_LVGL=ON. Any bus transfer during the reads fails the
+    benchmark, the adapter must only drain the event queue.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+
+#include "CST816S_LVGL.h"
+#include "host.h"
+#include "sim_cst816s.h"
+
+#define PIN_SDA 4
+#define PIN_SCL 5
+#define PIN_RST 6
+#define PIN_IRQ 7
+
+#define WIDTH 240
+#define HEIGHT 240
+
+static lv_color_t draw_buffer[WIDTH * 10];
+
+#if LVGL_VERSION_MAJOR >= 9
+static void flush(lv_display_t *display, const lv_area_t *area, uint8_t *pixels)
+{
+    (void)area;
+    (void)pixels;
+    lv_display_flush_ready(display);
+}
+
+static void start_lvgl()
+{
+    lv_init();
+    lv_display_t *display = lv_display_create(WIDTH, HEIGHT);
+    lv_display_set_buffers(display, draw_buffer, nullptr, sizeof(draw_buffer), LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_flush_cb(display, flush);
+}
+
+static lv_indev_read_cb_t adapter_read;
+static uint64_t callbacks = 0;
+
+// counts the calls LVGL makes to the adapter
+static void counting_read(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    callbacks++;
+    adapter_read(indev, data);
+}
+
+static void count_callbacks(lv_indev_t *indev)
+{
+    adapter_read = lv_indev_get_read_cb(indev);
+    lv_indev_set_read_cb(indev, counting_read);
+}
+
+static void read_indev(lv_indev_t *indev)
+{
+    lv_indev_read(indev);
+}
+#else
+static lv_disp_draw_buf_t disp_buffer;
+static lv_disp_drv_t disp_drv;
+
+static void flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *pixels)
+{
+    (void)area;
+    (void)pixels;
+    lv_disp_flush_ready(drv);
+}
+
+static void start_lvgl()
+{
+    lv_init();
+    lv_disp_draw_buf_init(&disp_buffer, draw_buffer, nullptr, WIDTH * 10);
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = WIDTH;
+    disp_drv.ver_res = HEIGHT;
+    disp_drv.flush_cb = flush;
+    disp_drv.draw_buf = &disp_buffer;
+    lv_disp_drv_register(&disp_drv);
+}
+
+static void (*adapter_read)(lv_indev_drv_t *drv, lv_indev_data_t *data);
+static uint64_t callbacks = 0;
+
+static void counting_read(lv_indev_drv_t *drv, lv_indev_data_t *data)
+{
+    callbacks++;
+    adapter_read(drv, data);
+}
+
+static void count_callbacks(lv_indev_t *indev)
+{
+    adapter_read = indev->driver->read_cb;
+    indev->driver->read_cb = counting_read;
+}
+
+static void read_indev(lv_indev_t *indev)
+{
+    lv_indev_read_timer_cb(indev->driver->read_timer);
+}
+#endif
+
+struct lvgl_rig
+{
+    CST816S_Sim sim;
+    CST816S touch;
+    CST816S_LVGL adapter;
+    lv_indev_t *indev;
+
+    lvgl_rig() : sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ), touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ), adapter(touch)
+    {
+        touch.begin();
+        indev = adapter.begin();
+        count_callbacks(indev);
+    }
+};
+
+static lvgl_rig *rig()
+{
+    static bool started = false;
+    if (!started)
+    {
+        host_reset();
+        start_lvgl();
+        started = true;
+    }
+    static lvgl_rig instance;
+    return &instance;
+}
+
+// nothing queued: the read LVGL runs every input period while the screen is not touched
+static void BM_LvglReadIdle(benchmark::State &state)
+{
+    lvgl_rig *r = rig();
+    uint32_t transfers = Wire.transfers();
+    for (auto _ : state)
+    {
+        read_indev(r->indev);
+    }
+    if (Wire.transfers() != transfers)
+    {
+        state.SkipWithError("read callback accessed the bus");
+    }
+}
+BENCHMARK(BM_LvglReadIdle);
+
+// a burst of queued moves drained in one LVGL read through continue_reading
+static void BM_LvglReadBurst(benchmark::State &state)
+{
+    lvgl_rig *r = rig();
+    int burst = state.range(0);
+    touch_event event = {};
+    event.event = 2;
+    event.points = 1;
+    uint64_t first = callbacks;
+    uint32_t transfers = Wire.transfers();
+    for (auto _ : state)
+    {
+        for (int i = 0; i < burst; i++)
+        {
+            event.x = (event.x + 1) % WIDTH;
+            r->touch.inject(event);
+        }
+
+        // only the read is timed, not queueing the events
+        auto start = std::chrono::steady_clock::now();
+        read_indev(r->indev);
+        state.SetIterationTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        if (r->touch.eventsPending() != 0)
+        {
+            state.SkipWithError("LVGL did not drain the burst in one read");
+            break;
+        }
+    }
+    if (Wire.transfers() != transfers)
+    {
+        state.SkipWithError("read callback accessed the bus");
+    }
+    state.SetItemsProcessed(state.iterations() * burst);
+    state.counters["reads_per_burst"] =
+        benchmark::Counter((double)(callbacks - first), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LvglReadBurst)->UseManualTime()->Arg(1)->Arg(4)->Arg(CST816S_EVENT_QUEUE_SIZE);
+
+BENCHMARK_MAIN();
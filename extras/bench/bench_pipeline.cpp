@@ -0,0 +1,148 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// The read pipeline on ESP32, run against the simulated controller on host threads with bus transfers
+// taking their time in real time at 100 kHz (810 us per report). Each iteration is a touch of REPORTS
+// reports at a fixed interval (second argument, us) while the sink spends SINK_WORK_US per event; the
+// first argument turns the reader task on. Counters: share of reports delivered, delivered events per
+// second, and mean and 99th percentile latency from the report to the sink in us.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+
+#define PIN_SDA 4
+#define PIN_SCL 5
+#define PIN_RST 6
+#define PIN_IRQ 7
+
+#define REPORTS 100
+#define SINK_WORK_US 300
+
+typedef std::chrono::steady_clock bench_clock;
+
+// spends SINK_WORK_US on each event, as a UI would, and records when it arrived
+class WorkingSink : public CST816S_Sink
+{
+    public:
+        void onTouchEvent(const touch_event &event) override
+        {
+            bench_clock::time_point now = bench_clock::now();
+            int i = event.y * 160 + event.x;
+            if (i >= 0 && i < REPORTS)
+            {
+                latencies.push_back(std::chrono::duration<double, std::micro>(now - sent[i]).count());
+            }
+            while (bench_clock::now() - now < std::chrono::microseconds(SINK_WORK_US))
+            {
+            }
+        }
+
+        bench_clock::time_point sent[REPORTS];
+        std::vector<double> latencies;
+};
+
+static void BM_Pipeline(benchmark::State &state)
+{
+    const bool pipeline = state.range(0) != 0;
+    const auto interval = std::chrono::microseconds(state.range(1));
+
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.setMaxI2CClock(100000);
+    touch.begin();
+    WorkingSink sink;
+    touch.addSink(&sink);
+    if (pipeline && !touch.enablePipeline())
+    {
+        state.SkipWithError("no reader task");
+        return;
+    }
+    host_realtime_bus(true);
+
+    uint64_t reports = 0;
+    for (auto _ : state)
+    {
+        std::atomic<bool> fed{false};
+        std::thread feeder([&] {
+            bench_clock::time_point next = bench_clock::now();
+            for (int i = 0; i < REPORTS; i++)
+            {
+                std::this_thread::sleep_until(next);
+                sink.sent[i] = bench_clock::now();
+                sim.report(i == 0 ? 0 : i == REPORTS - 1 ? 1 : 2, i % 160, i / 160);
+                next += interval;
+            }
+            fed = true;
+        });
+        // keep polling until the last report had time to go through the bus and the sink
+        bench_clock::time_point drained = bench_clock::time_point::max();
+        while (bench_clock::now() < drained)
+        {
+            if (!touch.available())
+            {
+                std::this_thread::yield();
+            }
+            if (fed && drained == bench_clock::time_point::max())
+            {
+                drained = bench_clock::now() + std::chrono::milliseconds(5);
+            }
+        }
+        feeder.join();
+        reports += REPORTS;
+    }
+    touch.disablePipeline();
+
+    std::vector<double> &latencies = sink.latencies;
+    double mean = 0;
+    for (double l : latencies)
+    {
+        mean += l;
+    }
+    if (!latencies.empty())
+    {
+        mean /= latencies.size();
+        std::nth_element(latencies.begin(), latencies.begin() + latencies.size() * 99 / 100, latencies.end());
+    }
+    state.counters["delivered"] = reports > 0 ? (double)latencies.size() / reports : 0;
+    state.counters["events_per_second"] = benchmark::Counter((double)latencies.size(), benchmark::Counter::kIsRate);
+    state.counters["latency_us"] = mean;
+    state.counters["latency_p99_us"] = latencies.empty() ? 0 : latencies[latencies.size() * 99 / 100];
+}
+BENCHMARK(BM_Pipeline)
+    ->ArgsProduct({{0, 1}, {2000, 1000, 700}})
+    ->ArgNames({"pipeline", "interval_us"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// The typed register layer against hand-written shifts and masks: equal items_per_second means no overhead
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "CST816S_decode.h"
+#include "CST816S_regs.h"
+
+#define REGS_FRAMES 4096
+
+static std::vector<uint8_t> random_bytes(size_t count)
+{
+    std::vector<uint8_t> bytes(count);
+    uint32_t state = 12345;
+    for (auto &b : bytes)
+    {
+        state = state * 1664525 + 1013904223;
+        b = state >> 24;
+    }
+    return bytes;
+}
+
+// the decoding CST816S.cpp used before the register layer
+static inline void decode_raw(const uint8_t *raw, touch_event &event)
+{
+    event.gestureID = raw[0];
+    event.points = raw[1];
+    event.event = raw[2] >> 6;
+    event.x = ((raw[2] & 0x0F) << 8) + raw[3];
+    event.y = ((raw[4] & 0x0F) << 8) + raw[5];
+}
+
+static void BM_DecodeRegs(benchmark::State &state)
+{
+    std::vector<uint8_t> frames = random_bytes(REGS_FRAMES * 6);
+    std::vector<touch_event> events(REGS_FRAMES);
+    for (size_t i = 0; i < REGS_FRAMES; i++)
+    {
+        touch_event typed, raw;
+        cst816s_decode(frames.data() + i * 6, typed);
+        decode_raw(frames.data() + i * 6, raw);
+        if (typed.gestureID != raw.gestureID || typed.points != raw.points || typed.event != raw.event ||
+            typed.x != raw.x || typed.y != raw.y)
+        {
+            state.SkipWithError("typed and hand-written decoding differ");
+            return;
+        }
+    }
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < REGS_FRAMES; i++)
+        {
+            cst816s_decode(frames.data() + i * 6, events[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * REGS_FRAMES);
+}
+BENCHMARK(BM_DecodeRegs);
+
+static void BM_DecodeRaw(benchmark::State &state)
+{
+    std::vector<uint8_t> frames = random_bytes(REGS_FRAMES * 6);
+    std::vector<touch_event> events(REGS_FRAMES);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < REGS_FRAMES; i++)
+        {
+            decode_raw(frames.data() + i * 6, events[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * REGS_FRAMES);
+}
+BENCHMARK(BM_DecodeRaw);
+
+// composing IrqCtl from run-time flags, as setEventMask() does
+static void BM_EncodeRegs(benchmark::State &state)
+{
+    std::vector<uint8_t> flags = random_bytes(REGS_FRAMES);
+    std::vector<uint8_t> values(REGS_FRAMES);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < REGS_FRAMES; i++)
+        {
+            uint8_t f = flags[i];
+            values[i] = (CST816S_EN_TOUCH::set(f & 1) | CST816S_EN_CHANGE::set((f >> 1) & 1) |
+                         CST816S_EN_MOTION::set((f >> 2) & 1) | CST816S_ONCE_WLP::set((f >> 3) & 1))
+                            .bits;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * REGS_FRAMES);
+}
+BENCHMARK(BM_EncodeRegs);
+
+static void BM_EncodeRaw(benchmark::State &state)
+{
+    std::vector<uint8_t> flags = random_bytes(REGS_FRAMES);
+    std::vector<uint8_t> values(REGS_FRAMES);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < REGS_FRAMES; i++)
+        {
+            uint8_t f = flags[i];
+            values[i] = ((f & 1) << 6) | (((f >> 1) & 1) << 5) | (((f >> 2) & 1) << 4) | ((f >> 3) & 1);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * REGS_FRAMES);
+}
+BENCHMARK(BM_EncodeRaw);
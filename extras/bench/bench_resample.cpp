@@ -0,0 +1,87 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// Resampler cost per input report (items_per_second) and per output point (ns_per_point)
+
+#include <benchmark/benchmark.h>
+
+#include <math.h>
+
+#include "CST816S_resample.h"
+
+#define RESAMPLE_REPORTS 4096
+
+// one circle per second with reports 8-20 ms apart, generated up front so only the resampler is timed
+struct circle_stroke
+{
+    int16_t x[RESAMPLE_REPORTS];
+    int16_t y[RESAMPLE_REPORTS];
+    uint32_t interval[RESAMPLE_REPORTS];
+
+    circle_stroke()
+    {
+        uint32_t state = 7;
+        uint32_t t = 0;
+        for (int i = 0; i < RESAMPLE_REPORTS; i++)
+        {
+            x[i] = 120 + lroundf(100 * cosf(t * 6.2832e-6f));
+            y[i] = 140 + lroundf(100 * sinf(t * 6.2832e-6f));
+            state = state * 1664525 + 1013904223;
+            interval[i] = 8000 + (state >> 8) % 12001;
+            t += interval[i];
+        }
+    }
+};
+
+static void BM_Resample(benchmark::State &state)
+{
+    static const circle_stroke stroke;
+    CST816S_Resampler resampler(state.range(0));
+    uint32_t t = 0;
+    uint64_t points = 0;
+    size_t n = 0;
+    for (auto _ : state)
+    {
+        size_t i = n % RESAMPLE_REPORTS;
+        touch_event e = {};
+        e.event = n == 0 ? 0 : 2;
+        e.timestamp = t;
+        e.x = stroke.x[i];
+        e.y = stroke.y[i];
+        resampler.onTouchEvent(e);
+        resampled_point p;
+        while (resampler.read(p))
+        {
+            benchmark::DoNotOptimize(p);
+            points++;
+        }
+        t += stroke.interval[i];
+        n++;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["points_per_report"] = (double)points / state.iterations();
+    // seconds of CPU per output point
+    state.counters["time_per_point"] = benchmark::Counter((double)points, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_Resample)->Arg(60)->Arg(120)->Arg(240);
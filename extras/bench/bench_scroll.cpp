@@ -0,0 +1,97 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// Scroll engine ticks per second (items_per_second) against the floating-point reference, and how far
+// the fixed-point trajectory drifts from the exact one (max_error_px)
+
+#include <benchmark/benchmark.h>
+
+#include <math.h>
+
+#include "CST816S_scroll.h"
+#include "scroll_reference.h"
+
+#define SCROLL_CONTENT 100000
+
+template <typename Scroll> static void fling(Scroll &scroll, int dy)
+{
+    touch_event e = {};
+    e.event = 0;
+    e.y = 160;
+    scroll.onTouchEvent(e);
+    for (int i = 1; i <= 8; i++)
+    {
+        e.event = i == 8 ? 1 : 2;
+        e.y = 160 + dy * i;
+        e.timestamp += 10000;
+        scroll.onTouchEvent(e);
+    }
+}
+
+// ticks through flings, rubber banding and settling, starting a new fling whenever the last one ended
+template <typename Scroll> static void run_ticks(benchmark::State &state)
+{
+    Scroll scroll(SCROLL_CONTENT, 320);
+    scroll.scrollTo(SCROLL_CONTENT / 2);
+    int dy = -15;
+    for (auto _ : state)
+    {
+        if (!scroll.tick())
+        {
+            dy = -dy;
+            fling(scroll, dy);
+        }
+        benchmark::DoNotOptimize(scroll.offset());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ScrollTick(benchmark::State &state)
+{
+    run_ticks<CST816S_Scroll>(state);
+
+    // largest distance from the exact trajectory over flings of several speeds
+    double worst = 0;
+    for (int dy : {-40, -15, -3, 5, 25})
+    {
+        CST816S_Scroll scroll(SCROLL_CONTENT, 320);
+        scroll_reference reference(SCROLL_CONTENT, 320);
+        scroll.scrollTo(SCROLL_CONTENT / 2);
+        reference.scrollTo(SCROLL_CONTENT / 2);
+        fling(scroll, dy);
+        fling(reference, dy);
+        for (int tick = 0; tick < 2000 && (scroll.tick() | reference.tick()); tick++)
+        {
+            worst = fmax(worst, fabs(scroll.offsetQ16() / 65536.0 - reference.offset()));
+        }
+    }
+    state.counters["max_error_px"] = worst;
+}
+BENCHMARK(BM_ScrollTick);
+
+static void BM_ScrollTickFloat(benchmark::State &state)
+{
+    run_ticks<scroll_reference>(state);
+}
+BENCHMARK(BM_ScrollTickFloat);
@@ -0,0 +1,171 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/*
+    Stream protocol cost and capacity: encoding and decoding in memory, and
+    the sustained event rate end to end over a Linux pseudo-terminal.
+    bytes_per_event is the wire size including framing and CRC; uart_115200
+    is the event rate that size allows on a 115200 baud UART (10 bits per
+    byte), the usual limit on a device.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#include "CST816S_stream.h"
+#include "pty_link.h"
+
+#define STREAM_EVENTS 4096
+
+static std::vector<touch_event> drag_events(int count)
+{
+    std::vector<touch_event> events(count);
+    for (int i = 0; i < count; i++)
+    {
+        touch_event &e = events[i];
+        e = {};
+        e.event = i % 64 == 0 ? 0 : (i % 64 == 63 ? 1 : 2);
+        e.points = e.event != 1;
+        e.gestureID = i % 64 > 20 ? SWIPE_RIGHT : NONE;
+        e.x = 20 + 3 * (i % 64);
+        e.y = 120 + (i % 5);
+        e.timestamp = 10000 * i + (i % 7) * 13; // 100 reports/s with some jitter
+    }
+    return events;
+}
+
+static void count_bytes(const uint8_t *data, size_t length, void *arg)
+{
+    (void)data;
+    *static_cast<uint64_t *>(arg) += length;
+}
+
+static void append_bytes(const uint8_t *data, size_t length, void *arg)
+{
+    auto *bytes = static_cast<std::vector<uint8_t> *>(arg);
+    bytes->insert(bytes->end(), data, data + length);
+}
+
+static void count_event(const touch_event &event, void *arg)
+{
+    benchmark::DoNotOptimize(event.x);
+    (*static_cast<uint64_t *>(arg))++;
+}
+
+static void set_size_counters(benchmark::State &state, uint64_t bytes, uint64_t events)
+{
+    double perEvent = events ? (double)bytes / events : 0;
+    state.counters["bytes_per_event"] = perEvent;
+    state.counters["uart_115200"] = perEvent > 0 ? 11520 / perEvent : 0;
+}
+
+static void BM_StreamEncode(benchmark::State &state)
+{
+    std::vector<touch_event> events = drag_events(STREAM_EVENTS);
+    uint64_t bytes = 0;
+    CST816S_StreamEncoder encoder(count_bytes, &bytes, state.range(0));
+    for (auto _ : state)
+    {
+        for (auto &e : events)
+        {
+            encoder.encode(e);
+        }
+        encoder.flush();
+    }
+    state.SetItemsProcessed(state.iterations() * STREAM_EVENTS);
+    set_size_counters(state, bytes, encoder.eventsSent());
+}
+BENCHMARK(BM_StreamEncode)->Arg(1)->Arg(8)->Arg(32);
+
+static void BM_StreamDecode(benchmark::State &state)
+{
+    std::vector<touch_event> events = drag_events(STREAM_EVENTS);
+    std::vector<uint8_t> bytes;
+    CST816S_StreamEncoder encoder(append_bytes, &bytes, state.range(0));
+    for (auto &e : events)
+    {
+        encoder.encode(e);
+    }
+    encoder.flush();
+
+    uint64_t decoded = 0;
+    CST816S_StreamDecoder decoder(count_event, &decoded);
+    for (auto _ : state)
+    {
+        decoder.feed(bytes.data(), bytes.size());
+    }
+    state.SetItemsProcessed(decoded);
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_StreamDecode)->Arg(1)->Arg(8)->Arg(32);
+
+// device thread encoding into the pty as fast as it can, host decoding from the other end
+static void BM_StreamPty(benchmark::State &state)
+{
+    pty_link link;
+    if (!link.open())
+    {
+        state.SkipWithError("no pseudo-terminal");
+        return;
+    }
+    std::vector<touch_event> events = drag_events(STREAM_EVENTS);
+    uint8_t batch = state.range(0);
+    uint64_t decoded = 0;
+    uint64_t bytes = 0;
+    CST816S_StreamDecoder decoder(count_event, &decoded);
+    uint8_t buffer[4096];
+    for (auto _ : state)
+    {
+        uint64_t target = decoded + STREAM_EVENTS;
+        std::thread device([&]() {
+            CST816S_StreamEncoder encoder(pty_link::write_all, &link, batch);
+            for (auto &e : events)
+            {
+                encoder.encode(e);
+            }
+            encoder.flush();
+        });
+        while (decoded < target)
+        {
+            ssize_t n = read(link.host, buffer, sizeof(buffer));
+            if (n <= 0)
+            {
+                break;
+            }
+            bytes += n;
+            decoder.feed(buffer, n);
+        }
+        device.join();
+    }
+    link.close();
+    if (decoder.crcErrors() > 0)
+    {
+        state.SkipWithError("CRC errors on the pseudo-terminal");
+    }
+    state.SetItemsProcessed(decoded);
+    set_size_counters(state, bytes, decoded);
+}
+BENCHMARK(BM_StreamPty)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
@@ -0,0 +1,104 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// Generated traces: generation rate, and the driver replaying them through the simulated controller
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "tracegen.h"
+
+#define PIN_SDA 4
+#define PIN_SCL 5
+#define PIN_RST 6
+#define PIN_IRQ 7
+
+static void count_record(const trace_record &record, void *arg)
+{
+    benchmark::DoNotOptimize(record);
+    (*static_cast<uint64_t *>(arg))++;
+}
+
+static void BM_TraceGen(benchmark::State &state)
+{
+    tracegen_config config;
+    uint64_t records = 0;
+    CST816S_TraceGen gen(config, count_record, &records);
+    for (auto _ : state)
+    {
+        gen.interaction();
+    }
+    state.SetItemsProcessed(records);
+}
+BENCHMARK(BM_TraceGen);
+
+static void collect(const trace_record &record, void *arg)
+{
+    static_cast<std::vector<trace_record> *>(arg)->push_back(record);
+}
+
+// one generated report per iteration: controller report, interrupt, bus read, decode, queue
+static void BM_DriverTrace(benchmark::State &state)
+{
+    static std::vector<trace_record> trace;
+    if (trace.empty())
+    {
+        tracegen_config config;
+        CST816S_TraceGen gen(config, collect, &trace);
+        for (int i = 0; i < 500; i++)
+        {
+            gen.interaction();
+        }
+    }
+
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.begin();
+    uint64_t start = host_time();
+    size_t i = 0;
+    touch_event event;
+    for (auto _ : state)
+    {
+        if (i == trace.size())
+        {
+            i = 0;
+            start = host_time() + 10000; // replay again after the last report
+        }
+        const trace_record &record = trace[i++];
+        touch_event e;
+        cst816s_decode(record.frame, e);
+        host_advance(start + record.timestamp - host_time());
+        sim.report(e.event, e.x, e.y, e.gestureID);
+        touch.available();
+        touch.readEvent(event);
+    }
+    benchmark::DoNotOptimize(event);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DriverTrace);
@@ -0,0 +1,15 @@
+/*
+    LVGL configuration for the headless adapter benchmark, everything not set
+    here keeps LVGL's default. Used through LV_CONF_PATH, works with v8 and v9.
+*/
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 0
+#define LV_USE_ASSERT_MALLOC 0
+#define LV_BUILD_EXAMPLES 0
+
+#endif
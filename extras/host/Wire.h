@@ -0,0 +1,96 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_HOST_WIRE_H
+#define CST816S_HOST_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional> // as the ESP32 Wire.h, the driver header relies on it
+
+#define I2C_BUFFER_LENGTH 128
+
+/*
+    A device on the simulated bus, called once per transfer with the bytes
+    the master wrote or the number of bytes it requested.
+*/
+class TwoWireDevice
+{
+    public:
+        virtual ~TwoWireDevice() {}
+
+        /*!
+            @return endTransmission() status: 0 ok, 2 address NACK, 3 data NACK, 4 bus error
+        */
+        virtual uint8_t i2cWrite(const uint8_t *data, size_t length) = 0;
+
+        /*!
+            @return number of bytes supplied, fewer than length for a truncated read
+        */
+        virtual size_t i2cRead(uint8_t *data, size_t length) = 0;
+};
+
+/*
+    Wire as the library uses it. Transfers go to the device attached at the
+    address and advance the virtual clock by the time the bytes take at the
+    configured bus clock (9 bit times per byte, including the address byte).
+*/
+class TwoWire
+{
+    public:
+        bool begin(int sda = -1, int scl = -1, uint32_t frequency = 100000);
+        void end();
+        void setClock(uint32_t frequency);
+        uint32_t getClock() const { return _clock; }
+
+        void beginTransmission(uint16_t address);
+        size_t write(uint8_t data);
+        size_t write(const uint8_t *data, size_t length);
+        uint8_t endTransmission(bool sendStop = true);
+        size_t requestFrom(uint16_t address, size_t size, bool sendStop = true);
+        int available();
+        int read();
+
+        void attach(uint8_t address, TwoWireDevice *device);
+        uint32_t transfers() const { return _transfers; }
+
+    private:
+        TwoWireDevice *_devices[128] = {};
+        bool _started = false;
+        uint32_t _clock = 100000;
+        uint8_t _address = 0;
+        uint8_t _tx[I2C_BUFFER_LENGTH];
+        size_t _tx_length = 0;
+        uint8_t _rx[I2C_BUFFER_LENGTH];
+        size_t _rx_length = 0;
+        size_t _rx_index = 0;
+        uint32_t _transfers = 0;
+
+        void bus_time(size_t bytes);
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,204 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+#include "driver/gpio.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host.h"
+
+struct host_task
+{
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t notifications = 0;
+    bool deleted = false;
+};
+
+// taken in turn: on the device the reader task, of higher priority, gets a mutex as soon as it is given
+struct host_semaphore
+{
+    std::mutex lock;
+    std::condition_variable turn;
+    uint32_t next = 0;    // ticket of the next caller of xSemaphoreTake()
+    uint32_t serving = 0; // ticket holding the mutex
+};
+
+// thrown out of ulTaskNotifyTake() to end the thread of a deleted task
+struct host_task_deleted
+{
+};
+
+static thread_local host_task *current_task = nullptr;
+static uint32_t wake_sources = 0;
+
+int64_t esp_timer_get_time()
+{
+    return (int64_t)host_time();
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level)
+{
+    (void)gpio_num;
+    (void)level;
+    wake_sources |= 1UL << ESP_SLEEP_WAKEUP_EXT0;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup()
+{
+    wake_sources |= 1UL << ESP_SLEEP_WAKEUP_GPIO;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+    if (!(wake_sources & (1UL << source)))
+    {
+        return ESP_FAIL; // as ESP-IDF: the source was not enabled
+    }
+    wake_sources &= ~(1UL << source);
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    (void)gpio_num;
+    (void)intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num)
+{
+    (void)gpio_num;
+    return ESP_OK;
+}
+
+uint32_t host_wake_sources()
+{
+    return wake_sources;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreID)
+{
+    (void)name;
+    (void)stackDepth;
+    (void)priority;
+    (void)coreID;
+    host_task *task = new host_task;
+    // the handle is set before the task runs, as the caller may hand it to an interrupt handler
+    *createdTask = task;
+    task->thread = std::thread([task, code, parameters] {
+        current_task = task;
+        try
+        {
+            code(parameters);
+        }
+        catch (const host_task_deleted &)
+        {
+        }
+    });
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    {
+        std::lock_guard<std::mutex> guard(task->lock);
+        task->deleted = true;
+    }
+    task->wake.notify_one();
+    task->thread.join();
+    delete task;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    {
+        std::lock_guard<std::mutex> guard(task->lock);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+    if (higherPriorityTaskWoken != nullptr)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    (void)ticksToWait; // only portMAX_DELAY is used
+    host_task *task = current_task;
+    std::unique_lock<std::mutex> guard(task->lock);
+    while (task->notifications == 0 && !task->deleted)
+    {
+        task->wake.wait_for(guard, std::chrono::milliseconds(100));
+    }
+    if (task->deleted)
+    {
+        throw host_task_deleted();
+    }
+    uint32_t count = task->notifications;
+    task->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new host_semaphore;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    (void)ticksToWait; // only portMAX_DELAY is used
+    std::unique_lock<std::mutex> guard(semaphore->lock);
+    uint32_t ticket = semaphore->next++;
+    while (semaphore->serving != ticket)
+    {
+        semaphore->turn.wait_for(guard, std::chrono::milliseconds(100));
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    {
+        std::lock_guard<std::mutex> guard(semaphore->lock);
+        semaphore->serving++;
+    }
+    semaphore->turn.notify_all();
+    return pdTRUE;
+}
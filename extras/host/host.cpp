@@ -0,0 +1,311 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "Arduino.h"
+#include "FunctionalInterrupt.h"
+#include "Wire.h"
+#include "host.h"
+
+struct host_pin
+{
+    uint8_t mode;
+    uint8_t output; // level last written
+    int8_t drive;   // level forced from outside, -1 if released
+    std::function<void()> handler;
+};
+
+static std::atomic<uint64_t> now_us{0}; // moved by the reader task too on the ESP32 flavour
+static bool realtime_bus = false;
+static host_pin pins[HOST_PINS];
+static int interrupt_lock = 0;
+static uint64_t interrupt_pending = 0; // pins raised while interrupts were disabled
+static host_pin_hook watch_hook = nullptr;
+static void *watch_arg = nullptr;
+
+TwoWire Wire;
+
+uint64_t host_time()
+{
+    return now_us;
+}
+
+void host_advance(uint64_t us)
+{
+    now_us += us;
+}
+
+void host_realtime_bus(bool enable)
+{
+    realtime_bus = enable;
+}
+
+void host_reset()
+{
+    now_us = 0;
+    realtime_bus = false;
+    for (int i = 0; i < HOST_PINS; i++)
+    {
+        pins[i] = host_pin{INPUT, HIGH, -1, nullptr};
+    }
+    interrupt_lock = 0;
+    interrupt_pending = 0;
+    watch_hook = nullptr;
+    watch_arg = nullptr;
+}
+
+void host_interrupt(uint8_t pin)
+{
+    if (pin >= HOST_PINS || !pins[pin].handler)
+    {
+        return;
+    }
+    if (interrupt_lock > 0)
+    {
+        interrupt_pending |= 1ULL << pin;
+        return;
+    }
+    pins[pin].handler();
+}
+
+void host_drive(uint8_t pin, int level)
+{
+    if (pin < HOST_PINS)
+    {
+        pins[pin].drive = level;
+    }
+}
+
+void host_watch(host_pin_hook hook, void *arg)
+{
+    watch_hook = hook;
+    watch_arg = arg;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < HOST_PINS)
+    {
+        pins[pin].mode = mode;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin >= HOST_PINS)
+    {
+        return;
+    }
+    pins[pin].output = val;
+    if (watch_hook != nullptr)
+    {
+        watch_hook(pin, val, watch_arg);
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= HOST_PINS)
+    {
+        return LOW;
+    }
+    if (pins[pin].drive >= 0)
+    {
+        return pins[pin].drive;
+    }
+    // open drain: a released line floats high through its pull-up
+    return pins[pin].mode == OUTPUT ? pins[pin].output : HIGH;
+}
+
+unsigned long millis()
+{
+    return (unsigned long)(now_us / 1000);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)(uint32_t)now_us;
+}
+
+void delay(unsigned long ms)
+{
+    now_us += (uint64_t)ms * 1000;
+    std::this_thread::yield(); // let other threads run in wait loops
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    now_us += us;
+}
+
+void noInterrupts()
+{
+    interrupt_lock++;
+}
+
+void interrupts()
+{
+    if (interrupt_lock > 0 && --interrupt_lock == 0 && interrupt_pending)
+    {
+        uint64_t pending = interrupt_pending;
+        interrupt_pending = 0;
+        for (uint8_t pin = 0; pin < HOST_PINS; pin++)
+        {
+            if (pending & (1ULL << pin))
+            {
+                host_interrupt(pin);
+            }
+        }
+    }
+}
+
+void attachInterrupt(uint8_t pin, std::function<void()> handler, int mode)
+{
+    (void)mode;
+    if (pin < HOST_PINS)
+    {
+        pins[pin].handler = handler;
+    }
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void *), void *arg, int mode)
+{
+    attachInterrupt(pin, std::bind(handler, arg), mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < HOST_PINS)
+    {
+        pins[pin].handler = nullptr;
+    }
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+    (void)sda;
+    (void)scl;
+    _clock = frequency;
+    _started = true;
+    return true;
+}
+
+void TwoWire::end()
+{
+    _started = false;
+}
+
+void TwoWire::setClock(uint32_t frequency)
+{
+    _clock = frequency;
+}
+
+void TwoWire::attach(uint8_t address, TwoWireDevice *device)
+{
+    _devices[address & 0x7F] = device;
+}
+
+void TwoWire::bus_time(size_t bytes)
+{
+    // start, address byte, data bytes and stop, 9 clocks per byte
+    uint64_t us = ((bytes + 1) * 9 * 1000000ULL + _clock - 1) / _clock;
+    now_us += us;
+    if (realtime_bus)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+void TwoWire::beginTransmission(uint16_t address)
+{
+    _address = address & 0x7F;
+    _tx_length = 0;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+    if (_tx_length >= sizeof(_tx))
+    {
+        return 0;
+    }
+    _tx[_tx_length++] = data;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+    size_t n = 0;
+    while (n < length && write(data[n]))
+    {
+        n++;
+    }
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    (void)sendStop;
+    _transfers++;
+    if (!_started)
+    {
+        return 4;
+    }
+    bus_time(_tx_length);
+    TwoWireDevice *device = _devices[_address];
+    return device == nullptr ? 2 : device->i2cWrite(_tx, _tx_length);
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool sendStop)
+{
+    (void)sendStop;
+    _transfers++;
+    _rx_length = 0;
+    _rx_index = 0;
+    TwoWireDevice *device = _devices[address & 0x7F];
+    if (!_started || device == nullptr)
+    {
+        return 0;
+    }
+    if (size > sizeof(_rx))
+    {
+        size = sizeof(_rx);
+    }
+    _rx_length = device->i2cRead(_rx, size);
+    bus_time(_rx_length);
+    return _rx_length;
+}
+
+int TwoWire::available()
+{
+    return _rx_length - _rx_index;
+}
+
+int TwoWire::read()
+{
+    return _rx_index < _rx_length ? _rx[_rx_index++] : -1;
+}
@@ -0,0 +1,71 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_HOST_H
+#define CST816S_HOST_H
+
+// Control of the host Arduino core from tests and benchmarks
+
+#include <stdint.h>
+
+#define HOST_PINS 64
+
+typedef void (*host_pin_hook)(uint8_t pin, uint8_t level, void *arg);
+
+/*!
+    @brief  virtual time in microseconds, as returned by micros() before it wraps
+*/
+uint64_t host_time();
+
+/*!
+    @brief  move the virtual clock forward
+*/
+void host_advance(uint64_t us);
+
+/*!
+    @brief  make bus transfers also take their duration in real time, for threads sharing the bus
+*/
+void host_realtime_bus(bool enable);
+
+/*!
+    @brief  start over at time 0 with all pins released, all interrupts detached and a virtual-time bus
+*/
+void host_reset();
+
+/*!
+    @brief  run the interrupt handler attached to a pin, deferred while interrupts are disabled
+*/
+void host_interrupt(uint8_t pin);
+
+/*!
+    @brief  drive a pin from outside, digitalRead() returns level; -1 releases the pin
+*/
+void host_drive(uint8_t pin, int level);
+
+/*!
+    @brief  observe digitalWrite(), e.g. a simulated device watching its reset line
+*/
+void host_watch(host_pin_hook hook, void *arg);
+
+#endif
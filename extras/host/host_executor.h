@@ -0,0 +1,120 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_HOST_EXECUTOR_H
+#define CST816S_HOST_EXECUTOR_H
+
+/*
+    Runs coroutines awaiting CST816S_Await on the host: host_task is a
+    minimal eagerly started coroutine type, and host_executor services the
+    driver in virtual time the way a firmware main loop would, so waiting
+    coroutines are resumed from available(). Needs C++20.
+*/
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+
+class host_task
+{
+    public:
+        struct promise_type
+        {
+            host_task get_return_object() { return host_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        host_task(host_task &&other) : _handle(std::exchange(other._handle, nullptr)) {}
+        host_task(const host_task &) = delete;
+        host_task &operator=(const host_task &) = delete;
+        ~host_task() { destroy(); }
+
+        bool done() const { return !_handle || _handle.done(); }
+
+        /*!
+            @brief  destroy the coroutine frame, also while it is suspended in a co_await
+        */
+        void destroy()
+        {
+            if (_handle)
+            {
+                _handle.destroy();
+                _handle = nullptr;
+            }
+        }
+
+    private:
+        explicit host_task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+        std::coroutine_handle<promise_type> _handle;
+};
+
+class host_executor
+{
+    public:
+        host_executor(CST816S &touch, CST816S_Sim &sim, uint32_t pollUs = 1000)
+            : _touch(touch), _sim(sim), _poll_us(pollUs) {}
+
+        /*!
+            @brief  one pass of the service loop: apply simulator faults, read pending reports (which
+                    resumes waiting coroutines), drain the event queue, then idle for the poll period
+        */
+        void poll()
+        {
+            _sim.update();
+            _touch.available();
+            touch_event event;
+            while (_touch.readEvent(event))
+            {
+            }
+            host_advance(_poll_us);
+        }
+
+        /*!
+            @brief  poll until done() returns true or the virtual time limit is reached
+          @return done()
+        */
+        template <typename Done> bool run_until(Done done, uint32_t timeoutMs)
+        {
+            uint64_t end = host_time() + timeoutMs * 1000ULL;
+            while (!done() && host_time() < end)
+            {
+                poll();
+            }
+            return done();
+        }
+
+    private:
+        CST816S &_touch;
+        CST816S_Sim &_sim;
+        uint32_t _poll_us;
+};
+
+#endif
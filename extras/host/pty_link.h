@@ -0,0 +1,91 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_PTY_LINK_H
+#define CST816S_PTY_LINK_H
+
+/*
+    A raw Linux pseudo-terminal standing in for the UART between a device
+    and the host: bytes written to the device end arrive at the host end
+    through the kernel's tty layer.
+*/
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+struct pty_link
+{
+    int device = -1; // master, written by the encoder
+    int host = -1;   // slave, read by the decoder
+
+    bool open()
+    {
+        device = posix_openpt(O_RDWR | O_NOCTTY);
+        if (device < 0 || grantpt(device) != 0 || unlockpt(device) != 0)
+        {
+            return false;
+        }
+        host = ::open(ptsname(device), O_RDWR | O_NOCTTY);
+        if (host < 0)
+        {
+            return false;
+        }
+        struct termios tio;
+        tcgetattr(host, &tio);
+        cfmakeraw(&tio);
+        return tcsetattr(host, TCSANOW, &tio) == 0;
+    }
+
+    void close()
+    {
+        if (host >= 0)
+        {
+            ::close(host);
+        }
+        if (device >= 0)
+        {
+            ::close(device);
+        }
+        host = device = -1;
+    }
+
+    static void write_all(const uint8_t *data, size_t length, void *arg)
+    {
+        int fd = static_cast<pty_link *>(arg)->device;
+        while (length > 0)
+        {
+            ssize_t n = ::write(fd, data, length);
+            if (n <= 0)
+            {
+                return;
+            }
+            data += n;
+            length -= n;
+        }
+    }
+};
+
+#endif
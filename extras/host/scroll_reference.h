@@ -0,0 +1,172 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_SCROLL_REFERENCE_H
+#define CST816S_SCROLL_REFERENCE_H
+
+/*
+    Floating-point model of CST816S_Scroll without paging: the same drag,
+    fling, overscroll and settle rules in double precision, to measure how
+    far the fixed-point trajectory drifts from the exact one.
+*/
+
+#include <math.h>
+
+#include "CST816S_decode.h"
+#include "CST816S_scroll.h"
+
+class scroll_reference
+{
+    public:
+        scroll_reference(double contentLength, double viewLength, uint16_t tickMs = 16)
+            : _tick_us(tickMs * 1000.0), _max(contentLength > viewLength ? contentLength - viewLength : 0),
+              _overscroll(floor(viewLength / 4))
+        {
+        }
+
+        void onTouchEvent(const touch_event &event)
+        {
+            int coord = event.y;
+            if (event.event == 0 || (event.event == 2 && _state != SCROLL_DRAG))
+            {
+                _state = SCROLL_DRAG;
+                _drag_pos = _pos;
+                _drag_start = coord;
+                _last_coord = coord;
+                _last_time = event.timestamp;
+                _velocity = 0;
+                return;
+            }
+            if (_state != SCROLL_DRAG)
+            {
+                return;
+            }
+            _pos = rubber_band(_drag_pos + (_drag_start - coord));
+            uint32_t dt = event.timestamp - _last_time;
+            if (dt > 100000)
+            {
+                _velocity = 0;
+            }
+            else if (coord != _last_coord && dt > 0)
+            {
+                _velocity += ((_last_coord - coord) * _tick_us / dt - _velocity) / 2;
+            }
+            _last_coord = coord;
+            _last_time = event.timestamp;
+            if (event.event == 1)
+            {
+                if (_pos < 0 || _pos > _max)
+                {
+                    _target = _pos < 0 ? 0 : _max;
+                    _velocity = 0;
+                    _state = SCROLL_SETTLE;
+                }
+                else
+                {
+                    _state = fabs(_velocity) < 0.125 ? SCROLL_IDLE : SCROLL_FLING;
+                }
+            }
+        }
+
+        bool tick()
+        {
+            switch (_state)
+            {
+            case SCROLL_FLING:
+                _pos += _velocity;
+                if (_pos < 0 || _pos > _max)
+                {
+                    double edge = _pos < 0 ? 0 : _max;
+                    _velocity *= 0.5;
+                    _pos = rubber_band(_pos);
+                    if (fabs(_velocity) < 0.125 || fabs(_pos - edge) >= _overscroll)
+                    {
+                        _velocity = 0;
+                        _target = edge;
+                        _state = SCROLL_SETTLE;
+                    }
+                    return true;
+                }
+                _velocity *= _friction;
+                if (fabs(_velocity) < 0.125)
+                {
+                    _velocity = 0;
+                    _state = SCROLL_IDLE;
+                }
+                return true;
+            case SCROLL_SETTLE:
+                if (fabs(_target - _pos) < 0.125)
+                {
+                    _pos = _target;
+                    _state = SCROLL_IDLE;
+                    return true;
+                }
+                _pos += (_target - _pos) * 0.25;
+                return true;
+            case SCROLL_DRAG:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        void scrollTo(double offset)
+        {
+            _pos = fmin(fmax(offset, 0), _max);
+            _velocity = 0;
+            _state = SCROLL_IDLE;
+        }
+
+        double offset() const { return _pos; }
+        uint8_t state() const { return _state; }
+
+    private:
+        double _tick_us;
+        double _max;
+        double _overscroll;
+        double _friction = 62259 / 65536.0;
+        uint8_t _state = SCROLL_IDLE;
+        double _pos = 0;
+        double _velocity = 0;
+        double _target = 0;
+        double _drag_pos = 0;
+        int _drag_start = 0;
+        int _last_coord = 0;
+        uint32_t _last_time = 0;
+
+        double rubber_band(double pos) const
+        {
+            if (pos < 0)
+            {
+                return -fmin(-pos / 2, _overscroll);
+            }
+            if (pos > _max)
+            {
+                return _max + fmin((pos - _max) / 2, _overscroll);
+            }
+            return pos;
+        }
+};
+
+#endif
@@ -0,0 +1,418 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "host.h"
+#include "sim_cst816s.h"
+
+#define SIM_ADDRESS 0x15
+
+/*!
+    @brief  Constructor for CST816S_Sim, attaches it to the bus and watches the reset line
+*/
+CST816S_Sim::CST816S_Sim(TwoWire &wire, uint8_t sda, uint8_t scl, uint8_t rst, uint8_t irq, uint8_t chipID) : _wire(wire)
+{
+    _sda = sda;
+    _scl = scl;
+    _rst = rst;
+    _irq = irq;
+    _chip_id = chipID;
+    power_on();
+    _boot_until = 0;
+    _wire.attach(SIM_ADDRESS, this);
+    host_watch(pin_changed, this);
+}
+
+CST816S_Sim::~CST816S_Sim()
+{
+    _wire.attach(SIM_ADDRESS, nullptr);
+    host_watch(nullptr, nullptr);
+}
+
+/*!
+    @brief  register contents after power on or reset, the configuration written by the driver is lost
+*/
+void CST816S_Sim::power_on()
+{
+    memset(_regs, 0, sizeof(_regs));
+    _regs[CST816S_REG_VERSION::address] = 0x01;
+    _regs[CST816S_REG_CHIP_ID::address] = _chip_id;
+    _regs[CST816S_REG_CHIP_ID::address + 1] = 0x00; // ProjID
+    _regs[CST816S_REG_CHIP_ID::address + 2] = 0x01; // FwVersion
+    _regs[CST816S_REG_AUTO_SLEEP_TIME::address] = 2;
+    _regs[CST816S_REG_IRQ_CTL::address] = (CST816S_EN_TOUCH::set(1) | CST816S_EN_CHANGE::set(1)).bits;
+    _regs[CST816S_REG_AUTO_RESET::address] = 5;
+    _regs[CST816S_REG_LONG_PRESS_TIME::address] = 10;
+    _pointer = 0;
+    _asleep = false;
+    _boot_until = host_time() + CST816S_SIM_BOOT_US;
+    _last_touch = _boot_until;
+    release_sda();
+}
+
+void CST816S_Sim::release_sda()
+{
+    if (_stuck_clocks > 0)
+    {
+        _stuck_clocks = 0;
+        host_drive(_sda, -1);
+    }
+}
+
+bool CST816S_Sim::responding() const
+{
+    return !_in_reset && !_asleep && host_time() >= _boot_until && !autoSleeping();
+}
+
+/*!
+    @brief  true while the controller is in its low-power scan: it sees touches but does not answer on the bus
+*/
+bool CST816S_Sim::autoSleeping() const
+{
+    uint8_t seconds = _regs[CST816S_REG_AUTO_SLEEP_TIME::address];
+    return _regs[CST816S_REG_DIS_AUTO_SLEEP::address] == 0 && seconds != 0 &&
+           host_time() >= _last_touch + seconds * 1000000ULL;
+}
+
+// a touch wakes the controller from its low-power scan, not from deep sleep, reset or boot
+bool CST816S_Sim::touched()
+{
+    if (_in_reset || _asleep || host_time() < _boot_until)
+    {
+        return false;
+    }
+    _last_touch = host_time();
+    return true;
+}
+
+void CST816S_Sim::pin_changed(uint8_t pin, uint8_t level, void *arg)
+{
+    CST816S_Sim *sim = static_cast<CST816S_Sim *>(arg);
+    std::lock_guard<std::recursive_mutex> guard(sim->_lock);
+    if (pin == sim->_scl && level == HIGH && sim->_stuck_clocks > 0)
+    {
+        // each clock lets the controller shift out one more bit of the byte it was sending
+        if (--sim->_stuck_clocks == 0)
+        {
+            host_drive(sim->_sda, -1);
+        }
+        return;
+    }
+    if (pin != sim->_rst)
+    {
+        return;
+    }
+    if (level == LOW)
+    {
+        sim->_in_reset = true;
+    }
+    else if (sim->_in_reset)
+    {
+        sim->_in_reset = false;
+        sim->_resets++;
+        sim->power_on();
+    }
+}
+
+void CST816S_Sim::report(uint8_t event, int x, int y, uint8_t gestureID)
+{
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (!touched())
+    {
+        return; // touches while the controller is reset or booting are lost
+    }
+    _regs[CST816S_REG_GESTURE_ID::address] = gestureID;
+    _regs[CST816S_REG_FINGER_NUM::address] = event == 1 ? 0 : 1;
+    store_point(CST816S_REG_XPOS_H::address, 0, event, x, y);
+    interrupt();
+}
+
+void CST816S_Sim::reportPoints(uint8_t event, int x, int y, int x2, int y2, uint8_t gestureID)
+{
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (!touched())
+    {
+        return;
+    }
+    _regs[CST816S_REG_GESTURE_ID::address] = gestureID;
+    _regs[CST816S_REG_FINGER_NUM::address] = event == 1 ? 0 : 2;
+    store_point(CST816S_REG_XPOS_H::address, 0, event, x, y);
+    store_point(CST816S_REG_XPOS_H2::address, 1, event, x2, y2);
+    interrupt();
+}
+
+// a point occupies 4 registers: event and X high bits, X low, touch ID and Y high bits, Y low
+void CST816S_Sim::store_point(uint8_t address, uint8_t id, uint8_t event, int x, int y)
+{
+    _regs[address] = CST816S_EVENT_FLAG::encode(event) | CST816S_XPOS_HIGH::encode(x >> 8);
+    _regs[address + 1] = x;
+    _regs[address + 2] = CST816S_TOUCH_ID::encode(id) | CST816S_YPOS_HIGH::encode(y >> 8);
+    _regs[address + 3] = y;
+}
+
+void CST816S_Sim::interrupt()
+{
+    if (!_in_reset && !_asleep)
+    {
+        host_interrupt(_irq);
+    }
+}
+
+/*!
+    @brief  inject a fault now
+  @param	fault
+      SIM_FAULT_*
+  @param	count
+      transfers, SCL clocks or interrupts affected, see the class description
+*/
+void CST816S_Sim::fault(uint8_t fault, uint16_t count)
+{
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    switch (fault)
+    {
+    case SIM_FAULT_NACK:
+        _nacks += count;
+        break;
+    case SIM_FAULT_STUCK_SDA:
+        _stuck_clocks = count > 0 ? count : 1;
+        host_drive(_sda, LOW);
+        break;
+    case SIM_FAULT_SHORT_READ:
+        _short_reads += count;
+        break;
+    case SIM_FAULT_SPURIOUS_IRQ:
+        _spurious += count;
+        break;
+    case SIM_FAULT_CHIP_RESET:
+        _resets++;
+        power_on();
+        // the report registers read as reserved event 3 until the next touch
+        memset(_regs + CST816S_REG_GESTURE_ID::address, 0xFF, 6);
+        host_interrupt(_irq);
+        _faults++;
+        break;
+    }
+}
+
+void CST816S_Sim::errorRate(uint32_t aboveHz, uint16_t perMille)
+{
+    _error_above = aboveHz;
+    _error_rate = perMille;
+}
+
+// true if this transfer is disturbed at the current bus clock, then _corrupt_next tells how
+bool CST816S_Sim::glitch()
+{
+    if (_error_rate == 0 || _wire.getClock() <= _error_above)
+    {
+        return false;
+    }
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    if (_random % 1000 >= _error_rate)
+    {
+        return false;
+    }
+    _faults++;
+    _corrupt_next = !_corrupt_next;
+    return true;
+}
+
+const char *CST816S_Sim::faultName(uint8_t fault)
+{
+    static const char *names[SIM_FAULT_COUNT] = {"nack", "stuck", "short", "spurious", "reset"};
+    return fault < SIM_FAULT_COUNT ? names[fault] : "none";
+}
+
+/*!
+    @brief  load a fault script, replacing the previous one
+    @return false if a step could not be parsed, the steps before it are kept
+*/
+bool CST816S_Sim::script(const char *text)
+{
+    _steps = 0;
+    _next_step = 0;
+    _script_start = host_time();
+    const char *p = text;
+    while (*p != '\0')
+    {
+        while (*p == ' ' || *p == ';' || *p == '\n' || *p == '\t')
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        if (_steps >= CST816S_SIM_SCRIPT)
+        {
+            return false;
+        }
+
+        char *end;
+        sim_step &step = _script[_steps];
+        step.ms = strtoul(p, &end, 10);
+        if (end == p)
+        {
+            return false;
+        }
+        p = end;
+        while (*p == ' ')
+        {
+            p++;
+        }
+        step.fault = SIM_FAULT_COUNT;
+        for (uint8_t f = 0; f < SIM_FAULT_COUNT; f++)
+        {
+            size_t n = strlen(faultName(f));
+            if (strncmp(p, faultName(f), n) == 0 && (p[n] == '\0' || strchr(" ;\n\t", p[n]) != nullptr))
+            {
+                step.fault = f;
+                p += n;
+                break;
+            }
+        }
+        if (step.fault == SIM_FAULT_COUNT)
+        {
+            return false;
+        }
+        while (*p == ' ')
+        {
+            p++;
+        }
+        step.count = 1;
+        if (*p >= '0' && *p <= '9')
+        {
+            step.count = strtoul(p, &end, 10);
+            p = end;
+        }
+        _steps++;
+    }
+    return true;
+}
+
+/*!
+    @brief  apply the script steps that are due and raise one pending spurious interrupt
+*/
+void CST816S_Sim::update()
+{
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    while (_next_step < _steps && host_time() >= _script_start + (uint64_t)_script[_next_step].ms * 1000)
+    {
+        fault(_script[_next_step].fault, _script[_next_step].count);
+        _next_step++;
+    }
+    if (_spurious > 0 && responding())
+    {
+        _spurious--;
+        _faults++;
+        memset(_regs + CST816S_REG_GESTURE_ID::address, 0xFF, 6);
+        host_interrupt(_irq);
+    }
+}
+
+uint8_t CST816S_Sim::i2cWrite(const uint8_t *data, size_t length)
+{
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (_stuck_clocks > 0)
+    {
+        _faults++;
+        return 4; // the master cannot generate a start condition
+    }
+    if (!responding())
+    {
+        return 2;
+    }
+    if (_nacks > 0)
+    {
+        _nacks--;
+        _faults++;
+        return 2;
+    }
+    if (glitch())
+    {
+        return 3; // a disturbed write is not acknowledged either way
+    }
+    _writes++;
+    if (length == 0)
+    {
+        return 0;
+    }
+    _pointer = data[0];
+    for (size_t i = 1; i < length; i++)
+    {
+        if (_pointer == CST816S_REG_DEEP_SLEEP::address && data[i] == 0x03)
+        {
+            _asleep = true; // only a reset wakes the controller up again
+        }
+        _regs[_pointer++] = data[i];
+    }
+    return 0;
+}
+
+size_t CST816S_Sim::i2cRead(uint8_t *data, size_t length)
+{
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (_stuck_clocks > 0 || !responding())
+    {
+        return 0;
+    }
+    if (_nacks > 0)
+    {
+        _nacks--;
+        _faults++;
+        return 0;
+    }
+    _reads++;
+    if (_short_reads > 0 && length > 1)
+    {
+        _short_reads--;
+        _faults++;
+        length /= 2;
+    }
+    bool disturbed = glitch();
+    if (disturbed && !_corrupt_next)
+    {
+        return 0; // lost arbitration or no acknowledge, nothing is received
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        data[i] = _regs[_pointer++];
+    }
+    if (disturbed)
+    {
+        data[_random % length] ^= 1 << (_random >> 8) % 8; // a sampling error flips a bit
+    }
+    if (_irq_in_read)
+    {
+        _irq_in_read = false;
+        host_advance(length * 9 * 1000000ULL / _wire.getClock() / 2); // halfway through the data bytes
+        interrupt();
+    }
+    return length;
+}
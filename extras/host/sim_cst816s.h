@@ -0,0 +1,187 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_SIM_H
+#define CST816S_SIM_H
+
+/*
+    Simulated CST816S on the host bus: a register file behind address 0x15
+    with auto-incrementing reads and writes, the reset line and the
+    interrupt line. report() stores a touch report the way the controller
+    does and pulses the interrupt, so the driver reads it through the same
+    path as on hardware.
+
+    Faults are injected directly with fault() or from a script of
+    "<ms> <fault> [count]" steps separated by ';' or newlines, timed from
+    the call to script() and applied by update() once the virtual clock
+    reaches them:
+
+        sim.script("300 nack 5; 600 stuck; 900 reset");
+
+    nack      the next count transfers are not acknowledged
+    stuck     SDA is held low until count SCL clocks (default 1) or a reset
+    short     the next count reads return half of the requested bytes
+    spurious  count interrupts without a report, one per update()
+    reset     the controller resets itself, losing its configuration
+
+    errorRate() makes transfers fail at random above a bus clock, to test
+    the clock negotiation and its fallback.
+
+    Unless DisAutoSleep (0xFE) is set, the controller drops to its low-power
+    scan AutoSleepTime (0xF9) seconds after the last touch and does not
+    acknowledge transfers until the next touch or a reset.
+
+    Reports, faults and transfers may come from different threads, e.g. a
+    test feeding reports while the driver's reader task reads them.
+*/
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+
+#include "Wire.h"
+#include "CST816S_regs.h"
+
+#define CST816S_SIM_BOOT_US 10000 // after reset the controller does not answer until its firmware runs
+#define CST816S_SIM_SCRIPT 16      // steps a fault script can hold
+
+enum SIM_FAULT
+{
+    SIM_FAULT_NACK,
+    SIM_FAULT_STUCK_SDA,
+    SIM_FAULT_SHORT_READ,
+    SIM_FAULT_SPURIOUS_IRQ,
+    SIM_FAULT_CHIP_RESET,
+    SIM_FAULT_COUNT
+};
+
+class CST816S_Sim : public TwoWireDevice
+{
+    public:
+        CST816S_Sim(TwoWire &wire, uint8_t sda, uint8_t scl, uint8_t rst, uint8_t irq, uint8_t chipID = 0xB4);
+        ~CST816S_Sim();
+
+        /*!
+            @brief  store a report of the first touch point and pulse the interrupt
+          @param	event
+              0 down, 1 up, 2 contact
+        */
+        void report(uint8_t event, int x, int y, uint8_t gestureID = 0);
+
+        /*!
+            @brief  store a report of two touch points, the second at 0x09 with ID 1, and pulse the interrupt
+        */
+        void reportPoints(uint8_t event, int x, int y, int x2, int y2, uint8_t gestureID = 0);
+
+        /*!
+            @brief  pulse the interrupt without storing a new report
+        */
+        void interrupt();
+
+        /*!
+            @brief  pulse the interrupt in the middle of the next read, as the next report does at high rates
+        */
+        void interruptDuringRead() { _irq_in_read = true; }
+
+        void fault(uint8_t fault, uint16_t count = 1);
+
+        /*!
+            @brief  make transfers unreliable above a bus clock, e.g. long cables: each transfer fails
+                    with the given probability, alternately not acknowledged or with a corrupted byte
+          @param	aboveHz
+              transfers at a clock above this one are affected
+          @param	perMille
+              failure probability in 1/1000, 0 disables, the sequence is deterministic
+        */
+        void errorRate(uint32_t aboveHz, uint16_t perMille);
+        bool script(const char *text);
+        void update();
+
+        static const char *faultName(uint8_t fault);
+
+        uint8_t reg(uint8_t address) const { return _regs[address]; }
+        void setReg(uint8_t address, uint8_t value) { _regs[address] = value; }
+
+        bool asleep() const { return _asleep; }
+        bool autoSleeping() const;
+        uint32_t resets() const { return _resets; }
+        uint32_t reads() const { return _reads; }
+        uint32_t writes() const { return _writes; }
+        uint32_t faults() const { return _faults; }
+
+        uint8_t i2cWrite(const uint8_t *data, size_t length) override;
+        size_t i2cRead(uint8_t *data, size_t length) override;
+
+    private:
+        struct sim_step
+        {
+            uint32_t ms;
+            uint8_t fault;
+            uint16_t count;
+        };
+
+        TwoWire &_wire;
+        uint8_t _sda;
+        uint8_t _scl;
+        uint8_t _rst;
+        uint8_t _irq;
+        uint8_t _chip_id;
+        uint8_t _regs[256];
+        uint8_t _pointer = 0;
+        bool _in_reset = false;
+        bool _asleep = false;
+        uint64_t _boot_until = 0;
+        uint64_t _last_touch = 0;
+        // counters are polled by tests while another thread transfers
+        std::atomic<uint32_t> _resets{0};
+        std::atomic<uint32_t> _reads{0};
+        std::atomic<uint32_t> _writes{0};
+        std::atomic<uint32_t> _faults{0}; // transfers failed or interrupts raised by injected faults
+
+        uint16_t _nacks = 0;
+        uint16_t _short_reads = 0;
+        uint16_t _spurious = 0;
+        uint16_t _stuck_clocks = 0; // SDA is held low while non-zero
+        uint32_t _error_above = 0;
+        uint16_t _error_rate = 0;
+        uint32_t _random = 0x2545F491; // xorshift state
+        bool _corrupt_next = false;
+        bool _irq_in_read = false;
+        std::recursive_mutex _lock; // the interrupt handler may transfer from inside report()
+        sim_step _script[CST816S_SIM_SCRIPT];
+        uint8_t _steps = 0;
+        uint8_t _next_step = 0;
+        uint64_t _script_start = 0;
+
+        void store_point(uint8_t address, uint8_t id, uint8_t event, int x, int y);
+        void power_on();
+        void release_sda();
+        bool responding() const;
+        bool touched();
+        bool glitch();
+        static void pin_changed(uint8_t pin, uint8_t level, void *arg);
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include "CST816S_analytics.h"
+
+static touch_event make_event(uint8_t event, int x, int y, uint32_t ms, uint8_t gestureID = NONE)
+{
+    touch_event e = {};
+    e.event = event;
+    e.points = event == 1 ? 0 : 1;
+    e.x = x;
+    e.y = y;
+    e.timestamp = ms * 1000;
+    e.gestureID = gestureID;
+    return e;
+}
+
+static uint32_t u32_at(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t u16_at(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+TEST(Analytics, CountsTouchesHeatmapAndDwell)
+{
+    CST816S_Analytics analytics(240, 240);
+
+    // 100 ms in the top left cell, three samples
+    analytics.onTouchEvent(make_event(0, 10, 10, 1000));
+    analytics.onTouchEvent(make_event(2, 12, 12, 1050));
+    analytics.onTouchEvent(make_event(1, 12, 12, 1100));
+    // 3 ms in the bottom right cell, two samples
+    analytics.onTouchEvent(make_event(0, 239, 239, 2000));
+    analytics.onTouchEvent(make_event(1, 239, 239, 2003));
+
+    EXPECT_EQ(analytics.touches(), 2u);
+    EXPECT_EQ(analytics.heatmap(0, 0), 2);
+    EXPECT_EQ(analytics.heatmap(7, 7), 1);
+    EXPECT_EQ(analytics.dwell(7), 1); // 64..127 ms
+    EXPECT_EQ(analytics.dwell(2), 1); // 2..3 ms
+
+    // a contact report without a down starts a touch too
+    analytics.onTouchEvent(make_event(2, 120, 120, 3000));
+    EXPECT_EQ(analytics.touches(), 3u);
+    EXPECT_EQ(analytics.heatmap(4, 4), 1);
+}
+
+TEST(Analytics, CountsGestureChangesOnly)
+{
+    CST816S_Analytics analytics(240, 240);
+    const uint8_t known[] = {SWIPE_UP, SWIPE_DOWN, SWIPE_LEFT, SWIPE_RIGHT, SINGLE_CLICK, DOUBLE_CLICK, LONG_PRESS};
+
+    uint32_t ms = 0;
+    for (uint8_t id : known)
+    {
+        // the controller repeats the gesture in every report until it changes
+        analytics.onTouchEvent(make_event(2, 50, 50, ms += 10, id));
+        analytics.onTouchEvent(make_event(2, 50, 50, ms += 10, id));
+        analytics.onTouchEvent(make_event(1, 50, 50, ms += 10, NONE));
+    }
+    analytics.onTouchEvent(make_event(2, 50, 50, ms += 10, LONG_PRESS));
+    // IDs the controller never reports are ignored
+    analytics.onTouchEvent(make_event(2, 50, 50, ms += 10, 0x07));
+    analytics.onTouchEvent(make_event(2, 50, 50, ms += 10, 0xFF));
+
+    for (uint8_t id : known)
+    {
+        EXPECT_EQ(analytics.gestures(id), id == LONG_PRESS ? 2u : 1u) << (int)id;
+    }
+    EXPECT_EQ(analytics.gestures(NONE), 0u);
+    EXPECT_EQ(analytics.gestures(0x07), 0u);
+    EXPECT_EQ(analytics.gestures(0xFF), 0u);
+}
+
+TEST(Analytics, SnapshotLayout)
+{
+    CST816S_Analytics analytics(240, 240);
+    analytics.onTouchEvent(make_event(0, 10, 10, 1000, SWIPE_LEFT));
+    analytics.onTouchEvent(make_event(1, 10, 10, 1100));
+    analytics.onTouchEvent(make_event(0, 130, 70, 2000, DOUBLE_CLICK));
+    analytics.onTouchEvent(make_event(1, 130, 70, 2001));
+
+    uint8_t buffer[512];
+    size_t size = analytics.snapshotSize();
+    ASSERT_EQ(size, 8u + 7 * 4 + CST816S_DWELL_BUCKETS * 2 + CST816S_HEATMAP_COLS * CST816S_HEATMAP_ROWS * 2);
+    EXPECT_EQ(analytics.snapshot(buffer, size - 1), 0u);
+    ASSERT_EQ(analytics.snapshot(buffer, sizeof(buffer)), size);
+
+    EXPECT_EQ(buffer[0], 0xA5);
+    EXPECT_EQ(buffer[1], 2);
+    EXPECT_EQ(buffer[2], CST816S_HEATMAP_COLS);
+    EXPECT_EQ(buffer[3], CST816S_HEATMAP_ROWS);
+    EXPECT_EQ(u32_at(buffer + 4), 2u);
+
+    const uint8_t *gestures = buffer + 8;
+    const uint32_t expected[7] = {0, 0, 1, 0, 0, 1, 0};
+    for (int slot = 0; slot < 7; slot++)
+    {
+        EXPECT_EQ(u32_at(gestures + 4 * slot), expected[slot]) << slot;
+    }
+
+    const uint8_t *dwell = gestures + 7 * 4;
+    for (int bucket = 0; bucket < CST816S_DWELL_BUCKETS; bucket++)
+    {
+        EXPECT_EQ(u16_at(dwell + 2 * bucket), analytics.dwell(bucket)) << bucket;
+    }
+    EXPECT_EQ(u16_at(dwell + 2 * 7), 1);
+    EXPECT_EQ(u16_at(dwell + 2 * 1), 1);
+
+    const uint8_t *heatmap = dwell + CST816S_DWELL_BUCKETS * 2;
+    EXPECT_EQ(u16_at(heatmap), 1);
+    EXPECT_EQ(u16_at(heatmap + 2 * (2 * CST816S_HEATMAP_COLS + 4)), 1);
+}
+
+TEST(Analytics, CountersSaturate)
+{
+    CST816S_Analytics analytics(240, 240);
+    for (uint32_t i = 0; i < 70000; i++)
+    {
+        analytics.onTouchEvent(make_event(0, 10, 10, i * 2));
+        analytics.onTouchEvent(make_event(1, 10, 10, i * 2 + 1));
+    }
+    EXPECT_EQ(analytics.touches(), 70000u);
+    EXPECT_EQ(analytics.heatmap(0, 0), 0xFFFF);
+    EXPECT_EQ(analytics.dwell(1), 0xFFFF);
+
+    analytics.reset();
+    EXPECT_EQ(analytics.touches(), 0u);
+    EXPECT_EQ(analytics.heatmap(0, 0), 0);
+}
@@ -0,0 +1,64 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CST816S_batch.h"
+#include "CST816S_decode.h"
+
+// the vector paths must match cst816s_decode() bit for bit, including counts that leave a scalar tail
+TEST(Batch, MatchesScalarDecode)
+{
+    const size_t count = 1003;
+    std::vector<uint8_t> frames(count * 6);
+    uint32_t state = 1;
+    for (auto &b : frames)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        b = state;
+    }
+
+    std::vector<uint8_t> gestureID(count), points(count), event(count);
+    std::vector<int16_t> x(count), y(count);
+    batch_events out = {gestureID.data(), points.data(), event.data(), x.data(), y.data()};
+    for (int rotation = 0; rotation < 4; rotation++)
+    {
+        cst816s_decode_batch(frames.data(), count, rotation, 240, 280, out);
+        for (size_t i = 0; i < count; i++)
+        {
+            touch_event e;
+            cst816s_decode(frames.data() + i * 6, e);
+            cst816s_rotate_point(e.x, e.y, rotation, 240, 280);
+            ASSERT_EQ(gestureID[i], cst816s_rotate_gesture(e.gestureID, rotation)) << cst816s_decode_batch_impl() << " frame " << i;
+            ASSERT_EQ(points[i], e.points);
+            ASSERT_EQ(event[i], e.event);
+            ASSERT_EQ(x[i], e.x) << "rotation " << rotation << " frame " << i;
+            ASSERT_EQ(y[i], e.y) << "rotation " << rotation << " frame " << i;
+        }
+    }
+}
@@ -0,0 +1,190 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "CST816S_broadcast.h"
+
+static touch_event numbered(uint32_t n)
+{
+    touch_event e = {};
+    e.event = 2;
+    e.timestamp = n;
+    return e;
+}
+
+// every field derived from n, so a copy mixing two events is caught
+static touch_event stamped(uint32_t n)
+{
+    touch_event e = {};
+    e.gestureID = n & 0xFF;
+    e.points = (n >> 8) & 0xFF;
+    e.event = n % 3;
+    e.x = (int)(n * 2654435761u);
+    e.y = (int)~n;
+    e.timestamp = n;
+    return e;
+}
+
+static bool intact(const touch_event &e)
+{
+    touch_event expected = stamped(e.timestamp);
+    return e.gestureID == expected.gestureID && e.points == expected.points && e.event == expected.event &&
+           e.x == expected.x && e.y == expected.y;
+}
+
+TEST(Broadcast, SlowSubscriberSkipsAhead)
+{
+    CST816S_Broadcast bus;
+    CST816S_Broadcast::Subscriber sub(bus);
+    for (uint32_t i = 0; i < CST816S_BROADCAST_SIZE + 5; i++)
+    {
+        bus.publish(numbered(i));
+    }
+    touch_event e;
+    ASSERT_TRUE(sub.read(e));
+    EXPECT_EQ(e.timestamp, 5u);
+    EXPECT_EQ(sub.lost(), 5u);
+    EXPECT_EQ(sub.lagged(), 1u);
+}
+
+// every event is either read in order or counted as lost, and the reader never waits for the producer
+TEST(Broadcast, ConcurrentPublish)
+{
+    const uint32_t total = 200000;
+    CST816S_Broadcast bus;
+    CST816S_Broadcast::Subscriber sub(bus);
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < total; i++)
+        {
+            bus.publish(numbered(i));
+        }
+    });
+
+    uint32_t read = 0;
+    uint32_t last = 0;
+    bool ordered = true;
+    touch_event e;
+    while (read + sub.lost() < total)
+    {
+        if (sub.read(e))
+        {
+            ordered = ordered && (read == 0 || e.timestamp > last);
+            last = e.timestamp;
+            read++;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(read + sub.lost(), total);
+    EXPECT_FALSE(sub.read(e));
+}
+
+struct reader_result
+{
+    uint32_t read = 0;
+    uint32_t lost = 0;
+    uint32_t lagged = 0;
+    uint32_t torn = 0;
+    uint32_t misplaced = 0; // events that are not the one the cursor accounting points at
+};
+
+// several subscribers read concurrently with the producer: none sees a torn event, every event is read or
+// counted as lost exactly once, and each event read is the one after those read and lost before it
+TEST(Broadcast, ConcurrentReaders)
+{
+    const uint32_t total = 1000000;
+    for (int readers : {2, 4, 8})
+    {
+        CST816S_Broadcast bus;
+        std::vector<CST816S_Broadcast::Subscriber *> subs;
+        for (int r = 0; r < readers; r++)
+        {
+            subs.push_back(new CST816S_Broadcast::Subscriber(bus));
+        }
+        std::vector<reader_result> results(readers);
+        std::atomic<int> ready{0};
+
+        std::vector<std::thread> threads;
+        for (int r = 0; r < readers; r++)
+        {
+            threads.emplace_back([&, r] {
+                CST816S_Broadcast::Subscriber &sub = *subs[r];
+                reader_result &result = results[r];
+                ready++;
+                touch_event e;
+                while (result.read + sub.lost() < total)
+                {
+                    if (!sub.read(e))
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (!intact(e))
+                    {
+                        result.torn++;
+                    }
+                    if (e.timestamp != result.read + sub.lost())
+                    {
+                        result.misplaced++;
+                    }
+                    result.read++;
+                }
+                result.lost = sub.lost();
+                result.lagged = sub.lagged();
+            });
+        }
+        while (ready < readers)
+        {
+            std::this_thread::yield();
+        }
+        for (uint32_t i = 0; i < total; i++)
+        {
+            bus.publish(stamped(i));
+        }
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+
+        for (int r = 0; r < readers; r++)
+        {
+            const reader_result &result = results[r];
+            EXPECT_EQ(result.torn, 0u) << readers << " readers, reader " << r;
+            EXPECT_EQ(result.misplaced, 0u) << readers << " readers, reader " << r;
+            EXPECT_EQ(result.read + result.lost, total) << readers << " readers, reader " << r;
+            EXPECT_GT(result.read, 0u) << readers << " readers, reader " << r;
+            // each skip ahead loses at least one event
+            EXPECT_LE(result.lagged, result.lost) << readers << " readers, reader " << r;
+            touch_event e;
+            EXPECT_FALSE(subs[r]->read(e));
+            EXPECT_EQ(subs[r]->pending(), 0u);
+            delete subs[r];
+        }
+    }
+}
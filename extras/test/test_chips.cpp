@@ -0,0 +1,102 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+static uint32_t negotiated_clock(uint8_t chipID, uint32_t maxClock = 1000000, bool aboveChipLimit = false)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ, chipID);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.setMaxI2CClock(maxClock, aboveChipLimit);
+    touch.begin();
+    return touch.i2cClock();
+}
+
+TEST(Chips, ClockLimitedToPart)
+{
+    EXPECT_EQ(negotiated_clock(0xB4), 400000u);
+    EXPECT_EQ(negotiated_clock(0x20), 400000u);
+    EXPECT_EQ(negotiated_clock(0x42), 400000u); // unknown IDs are treated as CST816S
+    EXPECT_EQ(negotiated_clock(0xB4, 100000), 100000u);
+}
+
+TEST(Chips, ClockAbovePartOnRequest)
+{
+    EXPECT_EQ(negotiated_clock(0xB4, 1000000, true), 1000000u);
+    EXPECT_EQ(negotiated_clock(0x42, 1000000, true), 1000000u);
+    EXPECT_EQ(negotiated_clock(0xB4, 100000, true), 100000u);
+}
+
+TEST(Chips, Traits)
+{
+    EXPECT_STREQ(cst816s_chip_traits(0xB6).name, "CST816D");
+    EXPECT_EQ(cst816s_chip_traits(0xB4).maxPoints, 1);
+    EXPECT_EQ(cst816s_chip_traits(0x42).maxPoints, 1);
+    EXPECT_EQ(cst816s_chip_traits(0x42).maxClock, cst816s_chip_traits(0xB4).maxClock);
+    EXPECT_FALSE(cst816s_chip_traits(0x20).doubleClick);
+}
+
+// report two points from the simulated controller and return the points the driver decoded
+static uint8_t read_two_points(uint8_t chipID, touch_point *points, uint8_t maxPoints = 0)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ, chipID);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.setMaxPoints(maxPoints);
+    touch.begin();
+    sim.reportPoints(2, 40, 50, 300, 400);
+    EXPECT_TRUE(touch.available());
+    for (uint8_t i = 0; i < touch.data.touchCount; i++)
+    {
+        points[i] = touch.data.touches[i];
+    }
+    return touch.data.touchCount;
+}
+
+TEST(Chips, SecondPoint)
+{
+    touch_point points[CST816S_MAX_POINTS];
+    ASSERT_EQ(read_two_points(0xB4, points, 2), 2);
+    EXPECT_EQ(points[0].id, 0);
+    EXPECT_EQ(points[0].x, 40);
+    EXPECT_EQ(points[0].y, 50);
+    EXPECT_EQ(points[1].id, 1);
+    EXPECT_EQ(points[1].event, 2);
+    EXPECT_EQ(points[1].x, 300);
+    EXPECT_EQ(points[1].y, 400);
+}
+
+TEST(Chips, SinglePointPartReadsOnePoint)
+{
+    touch_point points[CST816S_MAX_POINTS];
+    ASSERT_EQ(read_two_points(0xB4, points), 1);
+    EXPECT_EQ(points[0].x, 40);
+    ASSERT_EQ(read_two_points(0x42, points), 1);
+}
@@ -0,0 +1,125 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+// a CST816S on a board where Fast-mode Plus is enabled with setMaxI2CClock(1000000, true)
+#define PROBED_CHIP 0xB4
+
+class Clock : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            host_reset();
+            sim = new CST816S_Sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ, PROBED_CHIP);
+            touch = new CST816S(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch->setMaxI2CClock(1000000, true);
+        }
+
+        void TearDown() override
+        {
+            delete touch;
+            delete sim;
+        }
+
+        // touch for the given time at 100 reports/s, polling every ms, return the events delivered
+        int drag(uint32_t ms)
+        {
+            int delivered = 0;
+            uint64_t end = host_time() + ms * 1000ULL;
+            uint64_t next = host_time();
+            while (host_time() < end)
+            {
+                if (host_time() >= next)
+                {
+                    sim->report(2, 100, 100);
+                    next = host_time() + 10000;
+                }
+                touch->available();
+                touch_event event;
+                while (touch->readEvent(event))
+                {
+                    delivered++;
+                }
+                host_advance(1000);
+            }
+            return delivered;
+        }
+
+        CST816S_Sim *sim;
+        CST816S *touch;
+};
+
+TEST_F(Clock, FastestWithoutErrors)
+{
+    touch->begin();
+    EXPECT_EQ(touch->i2cClock(), 1000000u);
+}
+
+TEST_F(Clock, SkipsUnreliableClocks)
+{
+    sim->errorRate(400000, 300);
+    touch->begin();
+    EXPECT_EQ(touch->i2cClock(), 400000u);
+    EXPECT_GT(sim->faults(), 0u);
+    EXPECT_EQ(touch->errors().nack, 0u); // probing failures are not reported
+}
+
+TEST_F(Clock, FallsBackToStandardMode)
+{
+    sim->errorRate(100000, 300);
+    touch->begin();
+    EXPECT_EQ(touch->i2cClock(), 100000u);
+}
+
+// even a low error rate is caught by the repeated probe reads
+TEST_F(Clock, RareErrorsAreCaught)
+{
+    sim->errorRate(400000, 100);
+    touch->begin();
+    EXPECT_EQ(touch->i2cClock(), 400000u);
+}
+
+// the bus degrades after begin(): bus errors lower the clock at the next recovery until reads succeed
+TEST_F(Clock, StepsDownAtRuntime)
+{
+    touch->begin();
+    ASSERT_EQ(touch->i2cClock(), 1000000u);
+    EXPECT_GT(drag(100), 5);
+
+    sim->errorRate(400000, 1000);
+    drag(200);
+    EXPECT_EQ(touch->i2cClock(), 400000u);
+    EXPECT_GE(touch->errors().recoveries, 1u);
+
+    uint32_t recoveries = touch->errors().recoveries;
+    EXPECT_GE(drag(200), 19);
+    EXPECT_EQ(touch->errors().recoveries, recoveries);
+}
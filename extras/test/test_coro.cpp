@@ -0,0 +1,219 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CST816S_coro.h"
+#include "host_executor.h"
+#include "test_pins.h"
+
+// every allocation of the test binary is counted, so a window of awaits can be checked for none
+static size_t allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+class Coro : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            host_reset();
+            sim = new CST816S_Sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch = new CST816S(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch->begin();
+            touch->addSink(&hub);
+            executor = new host_executor(*touch, *sim);
+        }
+
+        void TearDown() override
+        {
+            delete executor;
+            delete touch;
+            delete sim;
+        }
+
+        CST816S_Sim *sim;
+        CST816S *touch;
+        host_executor *executor;
+        CST816S_Await hub;
+};
+
+static host_task wait_events(CST816S_Await &hub, int count, touch_event *last, int *resumed)
+{
+    for (int i = 0; i < count; i++)
+    {
+        *last = co_await hub.nextEvent();
+        (*resumed)++;
+    }
+}
+
+static host_task wait_gesture(CST816S_Await &hub, uint8_t gestureID, touch_event *gesture)
+{
+    *gesture = co_await hub.nextGesture(gestureID);
+}
+
+TEST_F(Coro, ResumedFromAvailable)
+{
+    touch_event last = {};
+    int resumed = 0;
+    host_task task = wait_events(hub, 3, &last, &resumed);
+    EXPECT_TRUE(hub.waiting());
+
+    for (int i = 0; i < 3; i++)
+    {
+        sim->report(2, 10 * i, 20);
+        ASSERT_TRUE(executor->run_until([&] { return resumed == i + 1; }, 10));
+        EXPECT_EQ(last.x, 10 * i);
+    }
+    EXPECT_TRUE(task.done());
+    EXPECT_FALSE(hub.waiting());
+}
+
+TEST_F(Coro, GestureFilter)
+{
+    touch_event gesture = {};
+    host_task task = wait_gesture(hub, SWIPE_UP, &gesture);
+    sim->report(2, 50, 50, SWIPE_LEFT);
+    executor->run_until([] { return false; }, 5);
+    EXPECT_FALSE(task.done());
+
+    sim->report(2, 50, 50, SWIPE_UP);
+    ASSERT_TRUE(executor->run_until([&] { return task.done(); }, 10));
+    EXPECT_EQ(gesture.gestureID, SWIPE_UP);
+}
+
+TEST_F(Coro, AwaitingDoesNotAllocate)
+{
+    touch_event last = {};
+    int resumed = 0;
+    const int events = 1000;
+    host_task task = wait_events(hub, events, &last, &resumed); // the frame is the only allocation
+
+    size_t before = allocations;
+    for (int i = 0; i < events; i++)
+    {
+        sim->report(2, i % 240, 100);
+        executor->run_until([&] { return resumed == i + 1; }, 10);
+    }
+    EXPECT_EQ(resumed, events);
+    EXPECT_EQ(allocations - before, 0u);
+}
+
+// a coroutine destroyed while suspended unlinks its awaiter, the next event must not resume it
+TEST_F(Coro, DestroyedWhileWaiting)
+{
+    touch_event first = {}, second = {};
+    int resumedFirst = 0, resumedSecond = 0;
+    host_task a = wait_events(hub, 2, &first, &resumedFirst);
+    host_task b = wait_events(hub, 2, &second, &resumedSecond);
+    a.destroy();
+    EXPECT_TRUE(hub.waiting());
+
+    sim->report(2, 1, 2);
+    ASSERT_TRUE(executor->run_until([&] { return resumedSecond == 1; }, 10));
+    EXPECT_EQ(resumedFirst, 0);
+    b.destroy();
+    EXPECT_FALSE(hub.waiting());
+}
+
+// one resumed coroutine destroys another that is waiting for the same event
+TEST_F(Coro, DestroyedDuringResume)
+{
+    host_task *victim = nullptr;
+    auto killer = [](CST816S_Await &hub, host_task **victim) -> host_task {
+        co_await hub.nextEvent();
+        (*victim)->destroy();
+    };
+    touch_event last = {};
+    int resumed = 0;
+    host_task v = wait_events(hub, 1, &last, &resumed);
+    victim = &v;
+    host_task k = killer(hub, &victim); // pushed to the head, so resumed before the victim
+
+    hub.onTouchEvent(touch_event{});
+    EXPECT_TRUE(k.done());
+    EXPECT_EQ(resumed, 0);
+    EXPECT_FALSE(hub.waiting());
+}
+
+// Time from a report to the coroutine running: in virtual time through the driver, which a firmware loop
+// adds its poll period to, and in host time for the resume itself
+TEST_F(Coro, ResumeLatency)
+{
+    touch_event last = {};
+    int resumed = 0;
+    const int events = 200;
+    host_task task = wait_events(hub, events, &last, &resumed);
+
+    uint64_t worst = 0;
+    for (int i = 0; i < events; i++)
+    {
+        uint64_t reported = host_time();
+        sim->report(2, 100, 100);
+        ASSERT_TRUE(executor->run_until([&] { return resumed == i + 1; }, 10));
+        // run_until() idles a poll period after the pass that resumed the coroutine, what is left is
+        // the report transfer and decoding
+        uint64_t latency = host_time() - 1000 - reported;
+        worst = latency > worst ? latency : worst;
+    }
+    EXPECT_LE(worst, 1000u);
+
+    CST816S_Await direct;
+    int count = 0;
+    host_task waiter = wait_events(direct, 100000, &last, &count);
+    auto start = std::chrono::steady_clock::now();
+    touch_event event = {};
+    while (count < 100000)
+    {
+        direct.onTouchEvent(event);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    RecordProperty("resume_ns", (int)ns);
+    RecordProperty("driver_latency_us", (int)worst);
+    printf("resume %.1f ns, report transfer to resume at most %u us\n", ns, (unsigned)worst);
+}
@@ -0,0 +1,208 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// The driver built as for ESP32 against the host FreeRTOS threads: the read pipeline runs a real
+// reader task, the simulated bus takes its transfer time in real time, and a feeder thread plays
+// the controller.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "CST816S.h"
+#include "esp_sleep.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+#define REPORTS 400
+
+// records the events handed to it, on the task calling available()
+class RecordingSink : public CST816S_Sink
+{
+    public:
+        void onTouchEvent(const touch_event &event) override
+        {
+            events.push_back(event);
+            delivered++;
+        }
+        void onTouchError(uint8_t error, uint32_t /*timestamp*/) override { errors.push_back(error); }
+
+        std::vector<touch_event> events;
+        std::vector<uint8_t> errors;
+        std::atomic<int> delivered{0};
+};
+
+class Esp32 : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            host_reset();
+            sim = new CST816S_Sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch = new CST816S(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch->begin();
+            touch->addSink(&sink);
+        }
+
+        void TearDown() override
+        {
+            touch->disablePipeline();
+            delete touch;
+            delete sim;
+        }
+
+        // report number i carries its index in its coordinates
+        static int report_x(int i) { return i % 160; }
+        static int report_y(int i) { return i / 160; }
+
+        // Play a touch of REPORTS reports, each once the previous one was read off the bus and a slot is
+        // free for it. Faster, the controller overwrites reports not read yet, or the reader task finds
+        // both slots waiting for available() and counts a lost event, as on the device.
+        void feed()
+        {
+            for (int i = 0; i < REPORTS; i++)
+            {
+                auto limit = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+                while (sink.delivered < i - 1 && std::chrono::steady_clock::now() < limit)
+                {
+                    std::this_thread::yield();
+                }
+                uint32_t reads = sim->reads();
+                sim->report(i == 0 ? 0 : i == REPORTS - 1 ? 1 : 2, report_x(i), report_y(i));
+                while (sim->reads() == reads && std::chrono::steady_clock::now() < limit)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            fed = true;
+        }
+
+        // call available() until the feeder is done and all it fed was processed, running work between calls
+        template <typename Work> void run(Work work)
+        {
+            std::thread feeder(&Esp32::feed, this);
+            auto limit = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while ((!fed || sink.delivered < REPORTS) && std::chrono::steady_clock::now() < limit)
+            {
+                touch->available();
+                work();
+                std::this_thread::yield();
+            }
+            feeder.join();
+            while (touch->available())
+            {
+            }
+        }
+
+        void expect_in_order()
+        {
+            ASSERT_EQ(sink.events.size(), (size_t)REPORTS);
+            for (int i = 0; i < REPORTS; i++)
+            {
+                SCOPED_TRACE(i);
+                EXPECT_EQ(sink.events[i].event, i == 0 ? 0 : i == REPORTS - 1 ? 1 : 2);
+                EXPECT_EQ(sink.events[i].x, report_x(i));
+                EXPECT_EQ(sink.events[i].y, report_y(i));
+            }
+            EXPECT_TRUE(sink.errors.empty());
+            EXPECT_EQ(touch->errors().lostEvents, 0u);
+        }
+
+        CST816S_Sim *sim;
+        CST816S *touch;
+        RecordingSink sink;
+        std::atomic<bool> fed{false};
+};
+
+TEST_F(Esp32, PipelineDeliversInOrder)
+{
+    ASSERT_TRUE(touch->enablePipeline());
+    host_realtime_bus(true);
+    run([] {});
+    expect_in_order();
+}
+
+TEST_F(Esp32, ConfigurationWhileReading)
+{
+    ASSERT_TRUE(touch->enablePipeline());
+    host_realtime_bus(true);
+    int calls = 0;
+    run([&] {
+        // the transfers of the application task fall between the pointer write and the read of the reader task
+        switch (calls++ % 4)
+        {
+        case 0:
+            touch->set_auto_sleep_time(1 + calls % 30);
+            break;
+        case 1:
+            touch->setEventMask(CST816S_EVENT_ALL & ~CST816S_EVENT_GESTURE);
+            break;
+        case 2:
+            touch->setEventMask(CST816S_EVENT_ALL);
+            break;
+        case 3:
+            touch->enable_double_click();
+            break;
+        }
+    });
+    expect_in_order();
+    EXPECT_EQ(touch->errors().nack, 0u);
+    EXPECT_EQ(touch->errors().shortRead, 0u);
+
+    // the last of each configuration write arrived whole
+    touch->set_auto_sleep_time(42);
+    touch->setEventMask(CST816S_EVENT_ALL);
+    EXPECT_EQ(sim->reg(CST816S_REG_AUTO_SLEEP_TIME::address), 42);
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), CST816S_EN_DCLICK::set(1).bits);
+}
+
+TEST_F(Esp32, DisableReadsInAvailable)
+{
+    ASSERT_TRUE(touch->enablePipeline());
+    touch->disablePipeline();
+    sim->report(0, 10, 20);
+    EXPECT_TRUE(touch->available());
+    ASSERT_EQ(sink.events.size(), 1u);
+    EXPECT_EQ(sink.events[0].x, 10);
+}
+
+TEST_F(Esp32, WakeSourcesFollowGestureWake)
+{
+    const uint32_t sources = 1UL << ESP_SLEEP_WAKEUP_EXT0;
+    ASSERT_TRUE(touch->enterGestureWake());
+    EXPECT_EQ(host_wake_sources(), sources);
+
+    // the write and its retry after the reset are not acknowledged
+    sim->fault(SIM_FAULT_NACK, 2);
+    EXPECT_FALSE(touch->exitGestureWake());
+    EXPECT_TRUE(touch->gestureWakeActive());
+    EXPECT_EQ(host_wake_sources(), sources);
+
+    EXPECT_TRUE(touch->exitGestureWake());
+    EXPECT_EQ(host_wake_sources(), 0u);
+}
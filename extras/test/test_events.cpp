@@ -0,0 +1,318 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+// records the events handed to it
+class RecordingSink : public CST816S_Sink
+{
+    public:
+        void onTouchEvent(const touch_event &event) override { events.push_back(event); }
+        void onTouchError(uint8_t error, uint32_t /*timestamp*/) override { errors.push_back(error); }
+
+        std::vector<touch_event> events;
+        std::vector<uint8_t> errors;
+};
+
+class Events : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            host_reset();
+            sim = new CST816S_Sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch = new CST816S(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch->begin();
+        }
+
+        void TearDown() override
+        {
+            delete touch;
+            delete sim;
+        }
+
+        // down, three moves, a move that starts a swipe, a move and the lift: 7 reports
+        void swipe()
+        {
+            const uint8_t events[] = {0, 2, 2, 2, 2, 2, 1};
+            for (int i = 0; i < 7; i++)
+            {
+                sim->report(events[i], 100, 200 - 20 * i, i >= 4 ? SWIPE_UP : NONE);
+                touch->available();
+                host_advance(10000);
+            }
+        }
+
+        int queued()
+        {
+            int n = 0;
+            touch_event event;
+            while (touch->readEvent(event))
+            {
+                n++;
+            }
+            return n;
+        }
+
+        CST816S_Sim *sim;
+        CST816S *touch;
+};
+
+TEST_F(Events, IrqCtlPerMask)
+{
+    const struct
+    {
+        uint8_t mask;
+        uint8_t irqCtl;
+    } cases[] = {
+        {CST816S_EVENT_ALL, 0x70},
+        {CST816S_EVENT_GESTURE, 0x10},
+        {CST816S_EVENT_EDGE, 0x20},
+        {CST816S_EVENT_MOVE, 0x40},
+        {CST816S_EVENT_LONG_PRESS, 0x11}, // one interrupt per long press
+        {CST816S_EVENT_LONG_PRESS | CST816S_EVENT_MOVE, 0x50},
+        {CST816S_EVENT_EDGE | CST816S_EVENT_GESTURE, 0x30},
+        {CST816S_EVENT_EDGE | CST816S_EVENT_LONG_PRESS, 0x31},
+        {0, 0x00},
+    };
+    for (const auto &c : cases)
+    {
+        touch->setEventMask(c.mask);
+        EXPECT_EQ(sim->reg(CST816S_REG_IRQ_CTL::address), c.irqCtl) << "mask " << (int)c.mask;
+    }
+}
+
+TEST_F(Events, IrqCtlNotWrittenWithoutIrqControl)
+{
+    delete touch;
+    delete sim;
+    host_reset();
+    sim = new CST816S_Sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ, 0x20); // CST716
+    touch = new CST816S(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch->begin();
+    sim->setReg(CST816S_REG_IRQ_CTL::address, 0x5A);
+    touch->setEventMask(CST816S_EVENT_EDGE);
+    EXPECT_EQ(sim->reg(CST816S_REG_IRQ_CTL::address), 0x5A);
+}
+
+// MotionMask only enables gesture recognition, it is cleared while gestures are masked and restored after
+TEST_F(Events, MotionMaskFollowsGestures)
+{
+    sim->setReg(CST816S_REG_MOTION_MASK::address, 0x5A);
+    touch->setEventMask(CST816S_EVENT_EDGE);
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), 0x5A); // never configured, left alone
+
+    touch->setEventMask(CST816S_EVENT_ALL);
+    touch->enable_double_click();
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), 0x01);
+    touch->setEventMask(CST816S_EVENT_EDGE | CST816S_EVENT_LONG_PRESS);
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), 0x00);
+    touch->setEventMask(CST816S_EVENT_GESTURE);
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), 0x01);
+
+    // enabled while gestures are masked: takes effect when they are selected
+    touch->setEventMask(CST816S_EVENT_MOVE);
+    touch->enable_double_click();
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), 0x00);
+    touch->setEventMask(CST816S_EVENT_ALL);
+    EXPECT_EQ(sim->reg(CST816S_REG_MOTION_MASK::address), 0x01);
+}
+
+// a sink only sees the classes it subscribed to; every event counts once per sink, as a wakeup or as filtered
+TEST_F(Events, SinkMasks)
+{
+    RecordingSink all, gestures, edges;
+    ASSERT_TRUE(touch->addSink(&all));
+    ASSERT_TRUE(touch->addSink(&gestures, CST816S_EVENT_GESTURE));
+    ASSERT_TRUE(touch->addSink(&edges, CST816S_EVENT_EDGE));
+    swipe();
+
+    ASSERT_EQ(all.events.size(), 7u);
+    ASSERT_EQ(gestures.events.size(), 1u);
+    EXPECT_EQ(gestures.events[0].gestureID, SWIPE_UP);
+    EXPECT_EQ(gestures.events[0].event, 2);
+    ASSERT_EQ(edges.events.size(), 2u);
+    EXPECT_EQ(edges.events[0].event, 0);
+    EXPECT_EQ(edges.events[1].event, 1);
+
+    EXPECT_EQ(touch->sinkWakeups(), 7u + 1 + 2);
+    EXPECT_EQ(touch->sinkWakeupsFiltered(), 6u + 5);
+    EXPECT_EQ(queued(), 7); // sink masks do not affect the queue
+}
+
+// the event mask drops events before the queue and the sinks, they are not counted as filtered wakeups
+TEST_F(Events, EventMaskBeforeSinks)
+{
+    RecordingSink all;
+    touch->addSink(&all);
+    touch->setEventMask(CST816S_EVENT_EDGE | CST816S_EVENT_GESTURE);
+    swipe();
+
+    ASSERT_EQ(all.events.size(), 3u);
+    EXPECT_EQ(all.events[0].event, 0);
+    EXPECT_EQ(all.events[1].gestureID, SWIPE_UP);
+    EXPECT_EQ(all.events[2].event, 1);
+    EXPECT_EQ(touch->sinkWakeups(), 3u);
+    EXPECT_EQ(touch->sinkWakeupsFiltered(), 0u);
+    EXPECT_EQ(queued(), 3);
+}
+
+TEST_F(Events, AddSinkAgainChangesMask)
+{
+    RecordingSink sinks[CST816S_MAX_SINKS + 1];
+    for (int i = 0; i < CST816S_MAX_SINKS; i++)
+    {
+        ASSERT_TRUE(touch->addSink(&sinks[i], CST816S_EVENT_GESTURE));
+    }
+    EXPECT_FALSE(touch->addSink(&sinks[CST816S_MAX_SINKS]));
+    EXPECT_TRUE(touch->addSink(&sinks[0], CST816S_EVENT_EDGE)); // no new slot needed
+
+    swipe();
+    EXPECT_EQ(sinks[0].events.size(), 2u);
+    EXPECT_EQ(sinks[1].events.size(), 1u);
+    EXPECT_TRUE(sinks[CST816S_MAX_SINKS].events.empty());
+
+    touch->removeSink(&sinks[1]);
+    EXPECT_TRUE(touch->addSink(&sinks[CST816S_MAX_SINKS]));
+}
+
+// a report as read from register 0x01
+static void make_frame(uint8_t *frame, uint8_t event, int x, int y, uint8_t gestureID = NONE)
+{
+    frame[0] = gestureID;
+    frame[1] = 1;
+    frame[2] = event << 6 | x >> 8;
+    frame[3] = x;
+    frame[4] = y >> 8;
+    frame[5] = y;
+}
+
+TEST_F(Events, InjectedFramesReachQueueAndSinks)
+{
+    RecordingSink sink;
+    touch->addSink(&sink);
+    uint8_t frame[6];
+    const uint8_t events[] = {0, 2, 2, 1};
+    for (int i = 0; i < 4; i++)
+    {
+        make_frame(frame, events[i], 10 + i, 300 - i, i == 2 ? SWIPE_LEFT : NONE);
+        EXPECT_TRUE(touch->inject(frame, 1000 + i));
+    }
+    EXPECT_EQ(touch->data.x, 13);
+    EXPECT_EQ(touch->data.y, 297);
+
+    ASSERT_EQ(sink.events.size(), 4u);
+    touch_event event;
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(touch->readEvent(event));
+        EXPECT_EQ(event.event, events[i]);
+        EXPECT_EQ(event.x, 10 + i);
+        EXPECT_EQ(event.y, 300 - i);
+        EXPECT_EQ(event.timestamp, 1000u + i);
+        EXPECT_EQ(sink.events[i].timestamp, 1000u + i);
+    }
+    EXPECT_EQ(sink.events[2].gestureID, SWIPE_LEFT);
+    EXPECT_FALSE(touch->readEvent(event));
+}
+
+TEST_F(Events, InjectedObeyMasks)
+{
+    RecordingSink all, gestures;
+    touch->addSink(&all);
+    touch->addSink(&gestures, CST816S_EVENT_GESTURE);
+    touch->setEventMask(CST816S_EVENT_EDGE | CST816S_EVENT_GESTURE);
+
+    uint8_t frame[6];
+    make_frame(frame, 0, 50, 50);
+    EXPECT_TRUE(touch->inject(frame, 1));
+    make_frame(frame, 2, 50, 60);
+    EXPECT_FALSE(touch->inject(frame, 2)); // a move, masked
+    make_frame(frame, 2, 50, 70, SWIPE_DOWN);
+    EXPECT_TRUE(touch->inject(frame, 3));
+
+    touch_event event = {};
+    event.event = 2;
+    event.x = 50;
+    event.y = 80;
+    event.gestureID = SWIPE_DOWN;
+    event.timestamp = 4;
+    EXPECT_FALSE(touch->inject(event)); // same gesture again, only a move
+    event.event = 1;
+    event.timestamp = 5;
+    EXPECT_TRUE(touch->inject(event));
+
+    ASSERT_EQ(all.events.size(), 3u);
+    EXPECT_EQ(all.events[0].timestamp, 1u);
+    EXPECT_EQ(all.events[1].timestamp, 3u);
+    EXPECT_EQ(all.events[2].timestamp, 5u);
+    ASSERT_EQ(gestures.events.size(), 1u);
+    EXPECT_EQ(gestures.events[0].gestureID, SWIPE_DOWN);
+    EXPECT_EQ(queued(), 3);
+    EXPECT_EQ(touch->sinkWakeups(), 4u);
+    EXPECT_EQ(touch->sinkWakeupsFiltered(), 2u);
+}
+
+// invalid injected frames are reported, but never reset the controller
+TEST_F(Events, InjectedInvalidFrames)
+{
+    RecordingSink sink;
+    touch->addSink(&sink);
+    uint8_t frame[6];
+    make_frame(frame, 3, 0, 0);
+    for (int i = 0; i < CST816S_MAX_READ_ERRORS * 2; i++)
+    {
+        EXPECT_FALSE(touch->inject(frame, i));
+    }
+    EXPECT_EQ(touch->errors().invalidFrame, (uint32_t)CST816S_MAX_READ_ERRORS * 2);
+    EXPECT_EQ(touch->errors().recoveries, 0u);
+    EXPECT_EQ(sink.errors.size(), (size_t)CST816S_MAX_READ_ERRORS * 2);
+    EXPECT_TRUE(sink.events.empty());
+}
+
+// only reads from the bus show that it works again: injected frames leave the failure count alone
+TEST_F(Events, InjectedFramesKeepReadErrors)
+{
+    sim->fault(SIM_FAULT_NACK, CST816S_MAX_READ_ERRORS);
+    for (int i = 0; i < CST816S_MAX_READ_ERRORS - 1; i++)
+    {
+        sim->interrupt();
+        EXPECT_FALSE(touch->available());
+    }
+    uint8_t frame[6];
+    make_frame(frame, 0, 50, 50);
+    EXPECT_TRUE(touch->inject(frame, 1));
+    EXPECT_EQ(touch->errors().recoveries, 0u);
+
+    sim->interrupt();
+    EXPECT_FALSE(touch->available());
+    EXPECT_EQ(touch->errors().recoveries, 1u);
+}
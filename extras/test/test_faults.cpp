@@ -0,0 +1,247 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+class Faults : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            host_reset();
+            sim = new CST816S_Sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch = new CST816S(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+            touch->begin();
+        }
+
+        void TearDown() override
+        {
+            delete touch;
+            delete sim;
+        }
+
+        // drag for the given time at 100 reports/s, polling every ms, return the events delivered
+        int drag(uint32_t ms)
+        {
+            int delivered = 0;
+            uint64_t end = host_time() + ms * 1000ULL;
+            while (host_time() < end)
+            {
+                if (host_time() >= next_report)
+                {
+                    sim->report(2, 100, 100);
+                    next_report = host_time() + 10000;
+                }
+                sim->update();
+                touch->available();
+                touch_event event;
+                while (touch->readEvent(event))
+                {
+                    delivered++;
+                }
+                host_advance(1000);
+            }
+            return delivered;
+        }
+
+        CST816S_Sim *sim;
+        CST816S *touch;
+        uint64_t next_report = 0;
+};
+
+TEST_F(Faults, ScriptParses)
+{
+    EXPECT_TRUE(sim->script("10 nack 2; 20 stuck\n30 short 3;40 spurious; 50 reset"));
+    EXPECT_FALSE(sim->script("10 jam"));
+    EXPECT_FALSE(sim->script("nack 2"));
+}
+
+TEST_F(Faults, SingleNackLosesOneReport)
+{
+    sim->fault(SIM_FAULT_NACK);
+    drag(100);
+    EXPECT_EQ(touch->errors().nack, 1u);
+    EXPECT_EQ(touch->errors().lostEvents, 1u);
+    EXPECT_EQ(touch->errors().recoveries, 0u);
+}
+
+TEST_F(Faults, ShortReadIsDiscarded)
+{
+    sim->fault(SIM_FAULT_SHORT_READ);
+    drag(100);
+    EXPECT_EQ(touch->errors().shortRead, 1u);
+    EXPECT_EQ(touch->errors().recoveries, 0u);
+}
+
+TEST_F(Faults, StuckBusIsCleared)
+{
+    sim->fault(SIM_FAULT_STUCK_SDA, 9);
+    drag(200);
+    EXPECT_EQ(touch->errors().recoveries, 1u);
+    EXPECT_EQ(digitalRead(PIN_SDA), HIGH);
+    EXPECT_GT(drag(100), 8); // reports flow again
+}
+
+TEST_F(Faults, SpuriousInterruptsAreInvalidFrames)
+{
+    sim->script("0 spurious 2");
+    drag(100);
+    EXPECT_EQ(touch->errors().invalidFrame, 2u);
+    EXPECT_EQ(touch->errors().recoveries, 0u);
+}
+
+TEST_F(Faults, RepeatedFailuresRecover)
+{
+    sim->script("0 nack 3");
+    drag(200);
+    EXPECT_EQ(touch->errors().recoveries, 1u);
+    EXPECT_GE(touch->errors().recoveryTime, 55u); // reset pulse and start-up wait
+    EXPECT_GT(drag(100), 8);
+}
+
+TEST_F(Faults, ChipResetLosesConfiguration)
+{
+    touch->setEventMask(CST816S_EVENT_ALL & ~CST816S_EVENT_MOVE);
+    uint8_t irqCtl = sim->reg(CST816S_REG_IRQ_CTL::address);
+    sim->fault(SIM_FAULT_CHIP_RESET);
+    EXPECT_NE(sim->reg(CST816S_REG_IRQ_CTL::address), irqCtl);
+    drag(100);
+    EXPECT_EQ(touch->errors().nack, 1u); // the interrupt at start-up comes before the firmware answers
+    EXPECT_EQ(touch->errors().recoveries, 0u);
+}
+
+// distinct values in the configuration block 0xEC-0xFE, auto sleep disabled
+static void fill_config(CST816S_Sim &sim, uint8_t *block)
+{
+    for (int i = 0; i < CST816S_CONFIG_BLOCK; i++)
+    {
+        block[i] = 0x20 + i;
+        sim.setReg(CST816S_REG_MOTION_MASK::address + i, block[i]);
+    }
+}
+
+static void expect_config(CST816S_Sim &sim, const uint8_t *block)
+{
+    for (int i = 0; i < CST816S_CONFIG_BLOCK; i++)
+    {
+        EXPECT_EQ(sim.reg(CST816S_REG_MOTION_MASK::address + i), block[i]) << "register 0x" << std::hex << CST816S_REG_MOTION_MASK::address + i;
+    }
+}
+
+static void expect_gesture_wake(CST816S_Sim &sim)
+{
+    EXPECT_EQ(sim.reg(CST816S_REG_IRQ_CTL::address), CST816S_EN_MOTION::set(1).bits);
+    EXPECT_EQ(sim.reg(CST816S_REG_AUTO_SLEEP_TIME::address), CST816S_WAKE_SLEEP_TIME);
+    EXPECT_EQ(sim.reg(CST816S_REG_DIS_AUTO_SLEEP::address), 0);
+}
+
+TEST_F(Faults, GestureWakeRestoresBlock)
+{
+    uint8_t block[CST816S_CONFIG_BLOCK];
+    fill_config(*sim, block);
+    ASSERT_TRUE(touch->enterGestureWake());
+    expect_gesture_wake(*sim);
+
+    uint32_t resets = sim->resets();
+    EXPECT_TRUE(touch->exitGestureWake());
+    EXPECT_FALSE(touch->gestureWakeActive());
+    expect_config(*sim, block);
+    EXPECT_EQ(sim->resets(), resets);
+}
+
+// after CST816S_WAKE_SLEEP_TIME without touch the controller does not answer, the restore goes through a reset
+TEST_F(Faults, GestureWakeExitFromAutoSleep)
+{
+    uint8_t block[CST816S_CONFIG_BLOCK];
+    fill_config(*sim, block);
+    ASSERT_TRUE(touch->enterGestureWake());
+    host_advance(CST816S_WAKE_SLEEP_TIME * 1000000ULL + 100000);
+    ASSERT_TRUE(sim->autoSleeping());
+
+    uint32_t resets = sim->resets();
+    EXPECT_TRUE(touch->exitGestureWake());
+    EXPECT_FALSE(touch->gestureWakeActive());
+    EXPECT_EQ(sim->resets(), resets + 1);
+    expect_config(*sim, block);
+    EXPECT_FALSE(sim->autoSleeping());
+}
+
+// a gesture wakes the controller from its low-power scan, then the restore needs no reset
+TEST_F(Faults, GestureWakeExitAfterGesture)
+{
+    uint8_t block[CST816S_CONFIG_BLOCK];
+    fill_config(*sim, block);
+    ASSERT_TRUE(touch->enterGestureWake());
+    host_advance(CST816S_WAKE_SLEEP_TIME * 1000000ULL + 100000);
+    sim->report(2, 100, 100, DOUBLE_CLICK);
+    ASSERT_TRUE(touch->available());
+    EXPECT_EQ(touch->data.gestureID, DOUBLE_CLICK);
+
+    uint32_t resets = sim->resets();
+    EXPECT_TRUE(touch->exitGestureWake());
+    EXPECT_EQ(sim->resets(), resets);
+    expect_config(*sim, block);
+}
+
+// a failed restore keeps gesture wake and its saved configuration, a repeated call restores it
+TEST_F(Faults, GestureWakeExitRetries)
+{
+    uint8_t block[CST816S_CONFIG_BLOCK];
+    fill_config(*sim, block);
+    ASSERT_TRUE(touch->enterGestureWake());
+
+    sim->fault(SIM_FAULT_NACK, 2); // before and after the reset
+    EXPECT_FALSE(touch->exitGestureWake());
+    EXPECT_TRUE(touch->gestureWakeActive());
+    expect_gesture_wake(*sim);
+
+    EXPECT_TRUE(touch->exitGestureWake());
+    EXPECT_FALSE(touch->gestureWakeActive());
+    expect_config(*sim, block);
+}
+
+// the interrupt of the next report arrives while the current one is read: each keeps its own time
+TEST_F(Faults, InterruptDuringReadKeepsReportTime)
+{
+    host_advance(1000);
+    uint32_t reported = micros();
+    sim->report(2, 100, 100);
+    host_advance(500);
+    sim->interruptDuringRead();
+    ASSERT_TRUE(touch->available());
+    uint32_t next = micros();
+    touch_event event;
+    ASSERT_TRUE(touch->readEvent(event));
+    EXPECT_EQ(event.timestamp, reported);
+
+    ASSERT_TRUE(touch->available());
+    ASSERT_TRUE(touch->readEvent(event));
+    EXPECT_GT(event.timestamp, reported + 500);
+    EXPECT_LT(event.timestamp, next);
+}
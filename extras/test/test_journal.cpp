@@ -0,0 +1,120 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+#include "CST816S_journal.h"
+
+static void append_events(CST816S_Journal &journal, int from, int to)
+{
+    for (int i = from; i < to; i++)
+    {
+        touch_event e = {};
+        e.event = 2;
+        e.x = i;
+        e.y = 2 * i;
+        e.timestamp = 1000 * i;
+        journal.onTouchEvent(e);
+    }
+}
+
+static void expect_entries(CST816S_Journal &journal, int first, int count)
+{
+    ASSERT_EQ(journal.count(), (size_t)count);
+    for (int i = 0; i < count; i++)
+    {
+        journal_entry e;
+        ASSERT_TRUE(journal.entry(i, e));
+        EXPECT_EQ(e.timestamp, 1000u * (first + i));
+        EXPECT_EQ(e.x, first + i);
+    }
+}
+
+TEST(Journal, SurvivesRestart)
+{
+    journal_region region;
+    CST816S_Journal journal(region);
+    journal.clear();
+    append_events(journal, 0, 40);
+
+    CST816S_Journal after(region);
+    EXPECT_TRUE(after.begin());
+    expect_entries(after, 40 - CST816S_JOURNAL_SIZE, CST816S_JOURNAL_SIZE);
+}
+
+TEST(Journal, GarbageIsCleared)
+{
+    journal_region region;
+    memset(&region, 0xA5, sizeof(region));
+    CST816S_Journal journal(region);
+    EXPECT_FALSE(journal.begin());
+    EXPECT_EQ(journal.count(), 0u);
+}
+
+// reset after the entry words but before the check word: only the torn entry is lost
+TEST(Journal, TornAppendKeepsEarlierEntries)
+{
+    journal_region region;
+    CST816S_Journal journal(region);
+    journal.clear();
+    append_events(journal, 0, 10);
+    region.entries[10][0] = 0xDEADBEEF;
+    region.entries[10][1] = 0x12345678;
+
+    CST816S_Journal after(region);
+    EXPECT_TRUE(after.begin());
+    expect_entries(after, 0, 10);
+}
+
+// once wrapped, the torn entry had already overwritten the oldest one
+TEST(Journal, TornAppendAfterWrap)
+{
+    journal_region region;
+    CST816S_Journal journal(region);
+    journal.clear();
+    append_events(journal, 0, 40);
+    region.entries[40 % CST816S_JOURNAL_SIZE][0] = 0xDEADBEEF;
+
+    CST816S_Journal after(region);
+    EXPECT_TRUE(after.begin());
+    expect_entries(after, 40 - CST816S_JOURNAL_SIZE + 1, CST816S_JOURNAL_SIZE - 1);
+}
+
+// reset after the check word but before the entry count was advanced: the entry is kept
+TEST(Journal, CompletedAppendIsKept)
+{
+    journal_region region, complete;
+    CST816S_Journal journal(region), reference(complete);
+    journal.clear();
+    reference.clear();
+    append_events(journal, 0, 10);
+    append_events(reference, 0, 11);
+    memcpy(region.entries[10], complete.entries[10], sizeof(region.entries[10]));
+
+    CST816S_Journal after(region);
+    EXPECT_TRUE(after.begin());
+    expect_entries(after, 0, 11);
+}
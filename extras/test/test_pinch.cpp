@@ -0,0 +1,161 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "CST816S.h"
+#include "CST816S_pinch.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+// feed one report with two fingers, ids 0 and 1
+static void two_points(CST816S_Pinch &pinch, uint8_t event, float x0, float y0, float x1, float y1)
+{
+    touch_point points[2] = {};
+    points[0].id = 0;
+    points[0].event = event;
+    points[0].x = lroundf(x0);
+    points[0].y = lroundf(y0);
+    points[1].id = 1;
+    points[1].event = event;
+    points[1].x = lroundf(x1);
+    points[1].y = lroundf(y1);
+    pinch.onTouchPoints(points, 2, 0);
+}
+
+// fingers on a circle around (120, 120), radius and angle (degrees) moving from start to end in steps
+static void script(CST816S_Pinch &pinch, float r0, float r1, float a0, float a1, int steps = 10)
+{
+    for (int i = 0; i <= steps; i++)
+    {
+        float r = r0 + (r1 - r0) * i / steps;
+        float a = (a0 + (a1 - a0) * i / steps) / 57.29578f;
+        float dx = r * cosf(a);
+        float dy = r * sinf(a);
+        two_points(pinch, i == 0 ? 0 : 2, 120 - dx, 120 - dy, 120 + dx, 120 + dy);
+    }
+}
+
+TEST(Pinch, SpreadIsPinchOut)
+{
+    CST816S_Pinch pinch;
+    script(pinch, 40, 80, 0, 0);
+    ASSERT_TRUE(pinch.active());
+    EXPECT_NEAR(pinch.scale(), 2.0f, 0.01f);
+    EXPECT_NEAR(pinch.rotation(), 0.0f, 0.5f);
+    EXPECT_EQ(pinch.gesture(), PINCH_OUT);
+    EXPECT_EQ(pinch.centerX(), 120);
+    EXPECT_EQ(pinch.centerY(), 120);
+}
+
+TEST(Pinch, CloseIsPinchIn)
+{
+    CST816S_Pinch pinch;
+    script(pinch, 100, 50, 45, 45);
+    EXPECT_NEAR(pinch.scale(), 0.5f, 0.01f);
+    EXPECT_NEAR(pinch.rotation(), 0.0f, 0.5f);
+    EXPECT_EQ(pinch.gesture(), PINCH_IN);
+}
+
+TEST(Pinch, SmallChangesAreNoGesture)
+{
+    CST816S_Pinch pinch;
+    script(pinch, 80, 88, 10, 20);
+    EXPECT_NEAR(pinch.scale(), 1.1f, 0.01f);
+    EXPECT_NEAR(pinch.rotation(), 10.0f, 0.5f);
+    EXPECT_EQ(pinch.gesture(), MULTI_NONE);
+}
+
+// y grows downwards on the screen, so an increasing angle turns clockwise
+TEST(Pinch, Rotation)
+{
+    CST816S_Pinch cw;
+    script(cw, 80, 80, 0, 60);
+    EXPECT_NEAR(cw.rotation(), 60.0f, 0.5f);
+    EXPECT_NEAR(cw.scale(), 1.0f, 0.01f);
+    EXPECT_EQ(cw.gesture(), ROTATE_CW);
+
+    CST816S_Pinch ccw;
+    script(ccw, 80, 80, 30, -30);
+    EXPECT_NEAR(ccw.rotation(), -60.0f, 0.5f);
+    EXPECT_EQ(ccw.gesture(), ROTATE_CCW);
+
+    // rotation wins over a scale change beyond its threshold
+    CST816S_Pinch both;
+    script(both, 60, 90, 0, 30);
+    EXPECT_NEAR(both.scale(), 1.5f, 0.01f);
+    EXPECT_EQ(both.gesture(), ROTATE_CW);
+}
+
+// the angle is unwrapped across the +-180 degree boundary
+TEST(Pinch, RotationAcrossHalfTurn)
+{
+    CST816S_Pinch pinch;
+    script(pinch, 80, 80, 170, 200);
+    EXPECT_NEAR(pinch.rotation(), 30.0f, 0.5f);
+    EXPECT_EQ(pinch.gesture(), ROTATE_CW);
+}
+
+TEST(Pinch, LiftOrSingleFingerEnds)
+{
+    CST816S_Pinch pinch;
+    script(pinch, 40, 80, 0, 0);
+    ASSERT_TRUE(pinch.active());
+    two_points(pinch, 1, 40, 120, 200, 120);
+    EXPECT_FALSE(pinch.active());
+    EXPECT_EQ(pinch.gesture(), MULTI_NONE);
+
+    script(pinch, 40, 80, 0, 0);
+    touch_point one = {};
+    pinch.onTouchPoints(&one, 1, 0);
+    EXPECT_FALSE(pinch.active());
+
+    // the next pair is measured from where it went down
+    script(pinch, 80, 80, 0, 0);
+    EXPECT_NEAR(pinch.scale(), 1.0f, 0.01f);
+}
+
+// two points from the simulated controller reach the sink through the driver
+TEST(Pinch, FromDriver)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S_Pinch pinch;
+    touch.setMaxPoints(2);
+    touch.begin();
+    touch.addSink(&pinch);
+
+    sim.reportPoints(0, 100, 100, 140, 100);
+    ASSERT_TRUE(touch.available());
+    sim.reportPoints(2, 80, 100, 160, 100);
+    ASSERT_TRUE(touch.available());
+    EXPECT_TRUE(pinch.active());
+    EXPECT_NEAR(pinch.scale(), 2.0f, 0.01f);
+    EXPECT_EQ(pinch.gesture(), PINCH_OUT);
+    EXPECT_EQ(pinch.centerX(), 120);
+}
@@ -0,0 +1,131 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+
+static uint8_t classify(const touch_event &event, uint8_t &lastGesture)
+{
+    uint8_t classes = cst816s_event_class(event, lastGesture);
+    lastGesture = event.gestureID;
+    return classes;
+}
+
+static touch_event make_event(uint8_t event, uint8_t gestureID, int x)
+{
+    touch_event e = {};
+    e.event = event;
+    e.gestureID = gestureID;
+    e.x = x;
+    return e;
+}
+
+// contacts keep the gesture register set once a swipe is recognised, they are still moves
+TEST(EventQueue, SwipeContactsAreMoves)
+{
+    CST816S_EventQueue queue;
+    queue.setPolicy(QUEUE_KEEP_EDGES);
+    uint8_t last = NONE;
+
+    touch_event e = make_event(0, NONE, 0);
+    queue.push(e, classify(e, last));
+    for (int i = 0; i < 30; i++)
+    {
+        e = make_event(2, i < 3 ? NONE : SWIPE_UP, i);
+        queue.push(e, classify(e, last));
+    }
+    e = make_event(1, SWIPE_UP, 99);
+    queue.push(e, classify(e, last));
+
+    EXPECT_EQ(queue.stats().droppedEdges, 0u);
+    touch_event out;
+    int downs = 0, ups = 0, gestureStarts = 0;
+    uint8_t previous = NONE;
+    while (queue.pop(out))
+    {
+        downs += out.event == 0;
+        ups += out.event == 1;
+        gestureStarts += out.gestureID == SWIPE_UP && previous != SWIPE_UP;
+        previous = out.gestureID;
+    }
+    EXPECT_EQ(downs, 1);
+    EXPECT_EQ(ups, 1);
+    EXPECT_EQ(gestureStarts, 1); // the report that started the swipe is kept
+}
+
+TEST(EventQueue, MergeFoldsSwipeContacts)
+{
+    CST816S_EventQueue queue;
+    queue.setPolicy(QUEUE_MERGE_MOVES);
+    uint8_t last = NONE;
+    for (int i = 0; i < 40; i++)
+    {
+        touch_event e = make_event(2, i < 4 ? NONE : SWIPE_LEFT, i);
+        queue.push(e, classify(e, last));
+    }
+    touch_event out;
+    int count = 0;
+    while (queue.pop(out))
+    {
+        count++;
+    }
+    EXPECT_EQ(count, CST816S_EVENT_QUEUE_SIZE);
+    EXPECT_EQ(out.x, 39); // the newest position survived the merges
+    EXPECT_GT(queue.stats().merged, 0u);
+}
+
+// overload through the driver: nothing is read until the finger is lifted
+TEST(EventQueue, KeepEdgesOverload)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.begin();
+    touch.setQueuePolicy(QUEUE_KEEP_EDGES);
+
+    sim.report(0, 100, 200);
+    touch.available();
+    for (int i = 0; i < 30; i++)
+    {
+        host_advance(10000);
+        sim.report(2, 100, 200 - 4 * i, i < 3 ? NONE : SWIPE_UP);
+        touch.available();
+    }
+    host_advance(10000);
+    sim.report(1, 100, 80, SWIPE_UP);
+    touch.available();
+
+    touch_event event;
+    int ups = 0;
+    while (touch.readEvent(event))
+    {
+        ups += event.event == 1;
+    }
+    EXPECT_EQ(ups, 1);
+    EXPECT_EQ(touch.queueStats().droppedEdges, 0u);
+}
@@ -0,0 +1,185 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <vector>
+
+#include "CST816S_resample.h"
+
+#define RESAMPLE_RATE 120
+#define RESAMPLE_PERIOD (1000000 / RESAMPLE_RATE)
+
+// report intervals between 8 and 20 ms, the spread seen on the controller, in whole 2 ms steps so a
+// finger at 1 px/ms lands on whole pixels
+static uint32_t jittered_interval(uint32_t &state)
+{
+    state = state * 1664525 + 1013904223;
+    return 8000 + 2000 * ((state >> 8) % 7);
+}
+
+// feed a stroke following path(t) with jittered report times, collecting every output point
+template <typename Path>
+static std::vector<resampled_point> stroke(CST816S_Resampler &resampler, Path path, uint32_t durationUs,
+                                           std::vector<uint32_t> *reports = nullptr)
+{
+    std::vector<resampled_point> out;
+    uint32_t state = 7;
+    uint32_t t = 1000000;
+    uint32_t end = t + durationUs;
+    for (bool first = true; ; first = false)
+    {
+        bool last = t >= end;
+        touch_event e = {};
+        e.event = first ? 0 : last ? 1 : 2;
+        e.timestamp = t;
+        path(t - 1000000, e.x, e.y);
+        resampler.onTouchEvent(e);
+        if (reports != nullptr)
+        {
+            reports->push_back(t);
+        }
+        resampled_point p;
+        while (resampler.read(p))
+        {
+            out.push_back(p);
+        }
+        if (last)
+        {
+            break;
+        }
+        t += jittered_interval(state);
+    }
+    return out;
+}
+
+TEST(Resample, UniformGrid)
+{
+    CST816S_Resampler resampler(RESAMPLE_RATE);
+    auto line = [](uint32_t t, int &x, int &y) { x = t / 2000; y = 100; };
+    std::vector<resampled_point> out = stroke(resampler, line, 500000);
+    ASSERT_GT(out.size(), 50u);
+    EXPECT_EQ(out.front().event, 0);
+    EXPECT_EQ(out.back().event, 1);
+    for (size_t i = 1; i < out.size(); i++)
+    {
+        EXPECT_EQ(out[i].timestamp - out[i - 1].timestamp, (uint32_t)RESAMPLE_PERIOD);
+    }
+    EXPECT_EQ(resampler.dropped(), 0u);
+}
+
+// the non-uniform spline reproduces motion at constant speed whatever the report intervals
+TEST(Resample, ConstantSpeedIsExact)
+{
+    CST816S_Resampler resampler(RESAMPLE_RATE);
+    auto line = [](uint32_t t, int &x, int &y) { x = t / 1000; y = t / 500; };
+    std::vector<resampled_point> out = stroke(resampler, line, 300000);
+    double worst = 0;
+    for (size_t i = 1; i + 1 < out.size(); i++)
+    {
+        double t = (out[i].timestamp - 1000000) / 1000.0;
+        worst = fmax(worst, fmax(fabs(out[i].x - t), fabs(out[i].y - 2 * t)));
+    }
+    EXPECT_LT(worst, 0.01);
+}
+
+// a circle of 100 px radius drawn in one second: the resampled points stay on it
+TEST(Resample, CurveAccuracy)
+{
+    CST816S_Resampler resampler(RESAMPLE_RATE);
+    auto circle = [](uint32_t t, int &x, int &y) {
+        double a = 2 * M_PI * t / 1000000.0;
+        x = lround(120 + 100 * cos(a));
+        y = lround(140 + 100 * sin(a));
+    };
+    std::vector<resampled_point> out = stroke(resampler, circle, 1000000);
+    double worst = 0, sum = 0;
+    for (size_t i = 1; i + 1 < out.size(); i++)
+    {
+        double a = 2 * M_PI * (out[i].timestamp - 1000000) / 1000000.0;
+        double error = hypot(out[i].x - (120 + 100 * cos(a)), out[i].y - (140 + 100 * sin(a)));
+        worst = fmax(worst, error);
+        sum += error;
+    }
+    RecordProperty("mean_error_px", (int)(1000 * sum / (out.size() - 2)));
+    EXPECT_LT(sum / (out.size() - 2), 0.75);
+    EXPECT_LT(worst, 2.0);
+}
+
+// a point is emitted once the report after its segment arrived: at most two report intervals late
+TEST(Resample, BoundedLatency)
+{
+    CST816S_Resampler resampler(RESAMPLE_RATE);
+    std::vector<uint32_t> reports;
+    auto line = [](uint32_t t, int &x, int &y) { x = t / 2000; y = 0; };
+    std::vector<resampled_point> out;
+    uint32_t state = 3;
+    uint32_t t = 0;
+    for (int i = 0; i < 40; i++)
+    {
+        touch_event e = {};
+        e.event = i == 0 ? 0 : 2;
+        e.timestamp = t;
+        line(t, e.x, e.y);
+        resampler.onTouchEvent(e);
+        reports.push_back(t);
+        resampled_point p;
+        uint32_t newest = 0;
+        bool any = false;
+        while (resampler.read(p))
+        {
+            newest = p.timestamp;
+            any = true;
+        }
+        if (i >= 2 && any)
+        {
+            // everything before the report two back is out
+            EXPECT_GE(newest + RESAMPLE_PERIOD, reports[i - 1]);
+        }
+        t += jittered_interval(state);
+    }
+}
+
+TEST(Resample, NoSplineAcrossPauses)
+{
+    CST816S_Resampler resampler(RESAMPLE_RATE, 50);
+    const uint32_t times[] = {0, 10000, 20000, 200000, 210000, 220000};
+    const int xs[] = {0, 10, 20, 100, 110, 120};
+    for (int i = 0; i < 6; i++)
+    {
+        touch_event e = {};
+        e.event = i == 0 ? 0 : i == 5 ? 1 : 2;
+        e.timestamp = times[i];
+        e.x = xs[i];
+        resampler.onTouchEvent(e);
+    }
+    resampled_point p;
+    while (resampler.read(p))
+    {
+        // nothing is invented inside the pause
+        EXPECT_FALSE(p.timestamp > 20000 && p.timestamp < 200000) << p.timestamp;
+        EXPECT_LE(p.x, 120.5f);
+    }
+}
@@ -0,0 +1,116 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "CST816S_scroll.h"
+#include "scroll_reference.h"
+
+// a finger moving dy pixels per report every 10 ms, then lifted
+template <typename Scroll> static void swipe(Scroll &scroll, int y, int dy, int reports)
+{
+    touch_event e = {};
+    e.event = 0;
+    e.y = y;
+    e.timestamp = 1000000;
+    scroll.onTouchEvent(e);
+    for (int i = 1; i <= reports; i++)
+    {
+        e.event = i == reports ? 1 : 2;
+        e.y = y + dy * i;
+        e.timestamp += 10000;
+        scroll.onTouchEvent(e);
+    }
+}
+
+// run both until they stop and return the largest distance between them in pixels
+static double trajectory_error(CST816S_Scroll &scroll, scroll_reference &reference)
+{
+    double worst = fabs(scroll.offsetQ16() / 65536.0 - reference.offset());
+    for (int tick = 0; tick < 2000 && (scroll.state() != SCROLL_IDLE || reference.state() != SCROLL_IDLE); tick++)
+    {
+        scroll.tick();
+        reference.tick();
+        worst = fmax(worst, fabs(scroll.offsetQ16() / 65536.0 - reference.offset()));
+    }
+    return worst;
+}
+
+TEST(Scroll, ContentBeyondQ16Range)
+{
+    CST816S_Scroll scroll(40000, 320);
+    scroll.scrollTo(1000);
+    EXPECT_EQ(scroll.offset(), 1000);
+    scroll.scrollTo(50000);
+    EXPECT_EQ(scroll.offset(), 40000 - 320);
+}
+
+TEST(Scroll, FlingAtTheEndOfLongContent)
+{
+    CST816S_Scroll scroll(1000000, 320);
+    scroll.scrollTo(1000000 - 320 - 200);
+    swipe(scroll, 300, -20, 10);
+    int32_t last = scroll.offset();
+    for (int i = 0; i < 1000 && scroll.tick(); i++)
+    {
+        EXPECT_LE(scroll.offset(), 1000000 - 320 + 320 / 4);
+        EXPECT_GE(scroll.offset(), 1000000 - 320 - 200);
+        last = scroll.offset();
+    }
+    EXPECT_EQ(last, 1000000 - 320);
+}
+
+TEST(Scroll, PagesOfLongContent)
+{
+    CST816S_Scroll scroll(320 * 200, 320);
+    scroll.setPageSize(320);
+    scroll.scrollTo(320 * 150);
+    swipe(scroll, 300, -30, 5);
+    for (int i = 0; i < 1000 && scroll.tick(); i++)
+    {
+    }
+    EXPECT_EQ(scroll.offset(), 320 * 151);
+}
+
+TEST(Scroll, MatchesFloatReference)
+{
+    const int speeds[] = {-40, -15, -3, 5, 25};
+    for (int32_t content : {2000, 100000})
+    {
+        for (int dy : speeds)
+        {
+            SCOPED_TRACE(testing::Message() << "content " << content << " dy " << dy);
+            CST816S_Scroll scroll(content, 320);
+            scroll_reference reference(content, 320);
+            scroll.scrollTo(content / 2);
+            reference.scrollTo(content / 2);
+            swipe(scroll, 200, dy, 8);
+            swipe(reference, 200, dy, 8);
+            EXPECT_LT(trajectory_error(scroll, reference), 1.0);
+            EXPECT_NEAR(scroll.offsetQ16() / 65536.0, reference.offset(), 1.0);
+        }
+    }
+}
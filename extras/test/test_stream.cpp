@@ -0,0 +1,191 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "CST816S_stream.h"
+#include "pty_link.h"
+
+static std::vector<touch_event> make_events(int count)
+{
+    std::vector<touch_event> events;
+    for (int i = 0; i < count; i++)
+    {
+        touch_event e = {};
+        e.event = i == 0 ? 0 : (i == count - 1 ? 1 : 2);
+        e.points = e.event == 1 ? 0 : 1;
+        e.gestureID = i > count / 2 ? SWIPE_LEFT : NONE;
+        e.x = 200 - 3 * i;
+        e.y = 100 + (i & 3);
+        e.timestamp = 1000000 + 10000 * i;
+        events.push_back(e);
+    }
+    return events;
+}
+
+static void collect_bytes(const uint8_t *data, size_t length, void *arg)
+{
+    auto *bytes = static_cast<std::vector<uint8_t> *>(arg);
+    bytes->insert(bytes->end(), data, data + length);
+}
+
+static void collect_event(const touch_event &event, void *arg)
+{
+    static_cast<std::vector<touch_event> *>(arg)->push_back(event);
+}
+
+static void expect_same(const touch_event &a, const touch_event &b)
+{
+    EXPECT_EQ(a.event, b.event);
+    EXPECT_EQ(a.points, b.points);
+    EXPECT_EQ(a.gestureID, b.gestureID);
+    EXPECT_EQ(a.x, b.x);
+    EXPECT_EQ(a.y, b.y);
+    EXPECT_EQ(a.timestamp, b.timestamp);
+}
+
+TEST(Stream, RoundTripByteByByte)
+{
+    std::vector<uint8_t> bytes;
+    CST816S_StreamEncoder encoder(collect_bytes, &bytes, 4);
+    std::vector<touch_event> events = make_events(40);
+    for (auto &e : events)
+    {
+        encoder.encode(e);
+    }
+    encoder.flush();
+
+    std::vector<touch_event> decoded;
+    CST816S_StreamDecoder decoder(collect_event, &decoded);
+    for (uint8_t b : bytes)
+    {
+        decoder.feed(&b, 1);
+    }
+    ASSERT_EQ(decoded.size(), events.size());
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        expect_same(decoded[i], events[i]);
+    }
+    EXPECT_EQ(decoder.crcErrors(), 0u);
+}
+
+// a corrupted length byte must not swallow the frames after it
+TEST(Stream, ResyncAfterCorruptLength)
+{
+    std::vector<uint8_t> bytes;
+    CST816S_StreamEncoder encoder(collect_bytes, &bytes, 4);
+    std::vector<touch_event> events = make_events(40);
+    for (auto &e : events)
+    {
+        encoder.encode(e);
+    }
+    ASSERT_EQ(bytes[0], CST816S_STREAM_SYNC);
+    bytes[1] = 0xFF;
+
+    std::vector<touch_event> decoded;
+    CST816S_StreamDecoder decoder(collect_event, &decoded);
+    decoder.feed(bytes.data(), bytes.size());
+    ASSERT_EQ(decoded.size(), 36u);
+    expect_same(decoded[0], events[4]);
+    EXPECT_EQ(decoder.frames(), 9u);
+    EXPECT_GE(decoder.crcErrors(), 1u);
+}
+
+TEST(Stream, ResyncAfterNoise)
+{
+    std::vector<uint8_t> bytes = {CST816S_STREAM_SYNC, 3, CST816S_STREAM_SYNC, 0x00, CST816S_STREAM_SYNC};
+    CST816S_StreamEncoder encoder(collect_bytes, &bytes, 1);
+    std::vector<touch_event> events = make_events(3);
+    for (auto &e : events)
+    {
+        encoder.encode(e);
+    }
+
+    std::vector<touch_event> decoded;
+    CST816S_StreamDecoder decoder(collect_event, &decoded);
+    decoder.feed(bytes.data(), bytes.size());
+    ASSERT_EQ(decoded.size(), 3u);
+    expect_same(decoded[2], events[2]);
+}
+
+// a sync byte in the last position of a nearly full buffer has no length byte to check yet
+TEST(Stream, SyncByteAtEndOfBuffer)
+{
+    std::vector<uint8_t> bytes = {CST816S_STREAM_SYNC, 0xFF};
+    bytes.resize(2 + 255, 0x11);
+    bytes.push_back(CST816S_STREAM_SYNC);
+    CST816S_StreamEncoder encoder(collect_bytes, &bytes, 1);
+    std::vector<touch_event> events = make_events(5);
+    for (auto &e : events)
+    {
+        encoder.encode(e);
+    }
+
+    std::vector<touch_event> decoded;
+    CST816S_StreamDecoder decoder(collect_event, &decoded);
+    decoder.feed(bytes.data(), 2 + 255 + 1);
+    EXPECT_TRUE(decoded.empty());
+    decoder.feed(bytes.data() + 2 + 255 + 1, bytes.size() - (2 + 255 + 1));
+    ASSERT_EQ(decoded.size(), 5u);
+    expect_same(decoded[4], events[4]);
+}
+
+// encoder on one end of a pseudo-terminal, decoder on the other
+TEST(Stream, PseudoTerminal)
+{
+    pty_link link;
+    ASSERT_TRUE(link.open());
+
+    const int count = 20000;
+    std::vector<touch_event> events = make_events(count);
+    std::thread device([&]() {
+        CST816S_StreamEncoder encoder(pty_link::write_all, &link, 8);
+        for (auto &e : events)
+        {
+            encoder.encode(e);
+        }
+        encoder.flush();
+    });
+
+    std::vector<touch_event> decoded;
+    CST816S_StreamDecoder decoder(collect_event, &decoded);
+    uint8_t buffer[512];
+    while (decoded.size() < events.size())
+    {
+        ssize_t n = read(link.host, buffer, sizeof(buffer));
+        ASSERT_GT(n, 0);
+        decoder.feed(buffer, n);
+    }
+    device.join();
+    link.close();
+
+    for (int i = 0; i < count; i++)
+    {
+        expect_same(decoded[i], events[i]);
+    }
+    EXPECT_EQ(decoder.crcErrors(), 0u);
+}
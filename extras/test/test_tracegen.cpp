@@ -0,0 +1,170 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <vector>
+
+#include "CST816S.h"
+#include "host.h"
+#include "sim_cst816s.h"
+#include "test_pins.h"
+#include "tracegen.h"
+
+static void collect(const trace_record &record, void *arg)
+{
+    static_cast<std::vector<trace_record> *>(arg)->push_back(record);
+}
+
+static std::vector<trace_record> generate(const tracegen_config &config, int interactions)
+{
+    std::vector<trace_record> records;
+    CST816S_TraceGen gen(config, collect, &records);
+    for (int i = 0; i < interactions; i++)
+    {
+        gen.interaction();
+    }
+    return records;
+}
+
+TEST(TraceGen, SameSeedSameBytes)
+{
+    tracegen_config config;
+    config.seed = 42;
+    config.ghostsPerMinute = 20;
+    std::vector<trace_record> a = generate(config, 300);
+    std::vector<trace_record> b = generate(config, 300);
+    ASSERT_GT(a.size(), 1000u);
+    ASSERT_EQ(a.size(), b.size());
+    EXPECT_EQ(memcmp(a.data(), b.data(), a.size() * sizeof(trace_record)), 0);
+
+    config.seed = 43;
+    std::vector<trace_record> c = generate(config, 300);
+    EXPECT_TRUE(a.size() != c.size() || memcmp(a.data(), c.data(), a.size() * sizeof(trace_record)) != 0);
+}
+
+TEST(TraceGen, ReportIntervals)
+{
+    tracegen_config config;
+    config.jitterUs = 2000;
+    std::vector<trace_record> records = generate(config, 200);
+    for (size_t i = 1; i < records.size(); i++)
+    {
+        uint32_t gap = records[i].timestamp - records[i - 1].timestamp;
+        ASSERT_GE(gap, 8000u) << i;
+        if (CST816S_EVENT_FLAG::decode(records[i].frame[2]) != 0)
+        {
+            ASSERT_LE(gap, 12000u) << i; // within a touch, the report period and its jitter
+        }
+    }
+}
+
+// the position of each report follows its own timestamp: with jitter the reports lie on the path of the
+// same swipe generated without jitter
+TEST(TraceGen, SwipePositionFollowsTimestamp)
+{
+    for (uint64_t seed = 1; seed <= 20; seed++)
+    {
+        tracegen_config config;
+        config.seed = seed;
+        config.noisePx = 0;
+        config.jitterUs = 0;
+        std::vector<trace_record> regular;
+        CST816S_TraceGen(config, collect, &regular).swipe(SWIPE_RIGHT);
+
+        config.jitterUs = 4000;
+        std::vector<trace_record> jittered;
+        CST816S_TraceGen(config, collect, &jittered).swipe(SWIPE_RIGHT);
+        ASSERT_GE(regular.size(), 10u);
+
+        for (size_t i = 1; i + 1 < jittered.size(); i++)
+        {
+            touch_event e;
+            cst816s_decode(jittered[i].frame, e);
+            // interpolate the regular path, 10 ms between its reports
+            size_t k = jittered[i].timestamp / 10000;
+            if (k + 1 >= regular.size() - 1)
+            {
+                continue; // past the last contact report of the regular swipe
+            }
+            touch_event a, b;
+            cst816s_decode(regular[k].frame, a);
+            cst816s_decode(regular[k + 1].frame, b);
+            float f = (jittered[i].timestamp - regular[k].timestamp) / 10000.0f;
+            float x = a.x + (b.x - a.x) * f;
+            EXPECT_NEAR(e.x, x, 2.0f) << "seed " << seed << " report " << i;
+        }
+    }
+}
+
+struct replay
+{
+    CST816S_Sim *sim;
+    CST816S *touch;
+    uint64_t start;
+    int reports;
+    int mismatches;
+};
+
+// report each record from the simulated controller at its time and compare what the driver delivers
+static void replay_record(const trace_record &record, void *arg)
+{
+    replay *r = static_cast<replay *>(arg);
+    touch_event expected;
+    cst816s_decode(record.frame, expected);
+    host_advance(r->start + record.timestamp - host_time());
+    uint32_t at = micros();
+    r->sim->report(expected.event, expected.x, expected.y, expected.gestureID);
+    r->touch->available();
+
+    touch_event event;
+    r->reports++;
+    if (!r->touch->readEvent(event) || event.event != expected.event || event.x != expected.x ||
+        event.y != expected.y || event.gestureID != expected.gestureID || event.timestamp != at)
+    {
+        r->mismatches++;
+    }
+}
+
+// generated traces drive the simulated controller, every report reaches the application unchanged
+TEST(TraceGen, DrivesSimulator)
+{
+    host_reset();
+    CST816S_Sim sim(Wire, PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    CST816S touch(PIN_SDA, PIN_SCL, PIN_RST, PIN_IRQ);
+    touch.begin();
+
+    replay r = {&sim, &touch, host_time() + 1000, 0, 0};
+    tracegen_config config;
+    config.ghostsPerMinute = 10;
+    CST816S_TraceGen gen(config, replay_record, &r);
+    for (int i = 0; i < 100; i++)
+    {
+        gen.interaction();
+    }
+    EXPECT_EQ((uint64_t)r.reports, gen.records());
+    EXPECT_EQ(r.mismatches, 0);
+    EXPECT_EQ(touch.errors().lostEvents, 0u);
+}
@@ -0,0 +1,375 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/*
+    Offline analyzer for CST816S touch traces (see CST816S_trace.h).
+    Reports the report rate, read errors, gesture counts, histograms of the
+    report interval, touch duration and gesture latency (from the down to
+    the report that carries a new gesture) and contact jitter.
+
+    Build on the host:
+        g++ -O2 -std=c++17 -pthread -I../.. trace_analyzer.cpp ../../CST816S_dirty.cpp -o cst816s-trace
+
+    Usage:
+        cst816s-trace [-j threads] [-m mask] [-d frame_ms] trace.bin [trace.bin ...]
+
+    -m reports how many consumer wakeups a subscription mask of
+    CST816S_EVENT_* bits (e.g. -m 0x01 for gestures only) would leave
+    compared to waking on every report.
+
+    -d replays the trace through CST816S_Dirty at the given frame period and
+    compares the pixels of its dirty rectangles with redrawing the full screen
+    in every frame that had touch activity.
+
+    Each file is memory-mapped and split into one contiguous record range per
+    thread; the partial statistics are merged once all threads finish.
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "CST816S_trace.h"
+#include "CST816S_dirty.h"
+
+#define HIST_BUCKETS 32 // log2 buckets of microseconds
+
+struct stats
+{
+    uint64_t records = 0;
+    uint64_t errors = 0;
+    uint64_t events[4] = {};
+    uint64_t gestures[256] = {};
+    uint64_t interval[HIST_BUCKETS] = {};  // time between consecutive reports
+    uint64_t duration[HIST_BUCKETS] = {};  // time from down to up
+    uint64_t latency[HIST_BUCKETS] = {};   // time from down to the report that starts a gesture
+    uint64_t wakeups = 0; // events matching the subscription mask
+    // contact report interval moments for jitter
+    uint64_t contactIntervals = 0;
+    double intervalSum = 0;
+    double intervalSumSq = 0;
+
+    void merge(const stats &other)
+    {
+        records += other.records;
+        wakeups += other.wakeups;
+        errors += other.errors;
+        for (int i = 0; i < 4; i++)
+            events[i] += other.events[i];
+        for (int i = 0; i < 256; i++)
+            gestures[i] += other.gestures[i];
+        for (int i = 0; i < HIST_BUCKETS; i++)
+        {
+            interval[i] += other.interval[i];
+            duration[i] += other.duration[i];
+            latency[i] += other.latency[i];
+        }
+        contactIntervals += other.contactIntervals;
+        intervalSum += other.intervalSum;
+        intervalSumSq += other.intervalSumSq;
+    }
+};
+
+static int bucket(uint32_t us)
+{
+    int b = 0;
+    while (us > 1 && b < HIST_BUCKETS - 1)
+    {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/*!
+    @brief  analyze records [begin, end) of a trace
+*/
+static void analyze(const trace_header &header, const trace_record *records, size_t begin, size_t end, uint8_t mask, stats &out)
+{
+    if (begin >= end)
+        return; // empty range, e.g. more threads than records
+    uint8_t lastGesture = NONE;
+    for (size_t i = begin; i-- > 0;)
+    {
+        if (!(records[i].flags & CST816S_TRACE_FLAG_ERROR))
+        {
+            lastGesture = cst816s_rotate_gesture(records[i].frame[0], header.rotation);
+            break;
+        }
+    }
+
+    // find the down that an up at the start of the range belongs to
+    bool down = false;
+    uint32_t downTime = 0;
+    for (size_t i = begin; i-- > 0;)
+    {
+        if (records[i].flags & CST816S_TRACE_FLAG_ERROR)
+            continue;
+        uint8_t event = CST816S_EVENT_FLAG::decode(records[i].frame[2]);
+        if (event == 0 || event == 1)
+        {
+            down = event == 0;
+            downTime = records[i].timestamp;
+            break;
+        }
+    }
+
+    uint32_t previous = begin > 0 ? records[begin - 1].timestamp : records[begin].timestamp;
+    for (size_t i = begin; i < end; i++)
+    {
+        const trace_record &record = records[i];
+        uint32_t delta = record.timestamp - previous; // unsigned arithmetic handles wrap
+        previous = record.timestamp;
+        out.records++;
+        if (i > 0)
+            out.interval[bucket(delta)]++;
+
+        if (record.flags & CST816S_TRACE_FLAG_ERROR)
+        {
+            out.errors++;
+            continue;
+        }
+
+        touch_event event;
+        cst816s_trace_decode(header, record, event);
+        uint8_t classes = cst816s_event_class(event, lastGesture);
+        if (classes & mask)
+            out.wakeups++;
+        lastGesture = event.gestureID;
+        out.events[event.event & 3]++;
+        // the gesture register keeps its value over several reports, count each gesture once
+        if (classes & (CST816S_EVENT_GESTURE | CST816S_EVENT_LONG_PRESS))
+        {
+            out.gestures[event.gestureID]++;
+            if (down)
+                out.latency[bucket(record.timestamp - downTime)]++;
+        }
+
+        switch (event.event)
+        {
+        case 0:
+            down = true;
+            downTime = record.timestamp;
+            break;
+        case 1:
+            if (down)
+                out.duration[bucket(record.timestamp - downTime)]++;
+            down = false;
+            break;
+        case 2:
+            if (i > 0)
+            {
+                out.contactIntervals++;
+                out.intervalSum += delta;
+                out.intervalSumSq += (double)delta * delta;
+            }
+            break;
+        }
+    }
+}
+
+static void print_histogram(const char *title, const uint64_t *hist)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+        total += hist[i];
+    printf("%s\n", title);
+    if (total == 0)
+    {
+        printf("  (none)\n");
+        return;
+    }
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        if (hist[i] == 0)
+            continue;
+        printf("  %10llu - %10llu us  %12llu  %5.1f%%\n",
+               i == 0 ? 0ULL : 1ULL << i, (2ULL << i) - 1,
+               (unsigned long long)hist[i], 100.0 * hist[i] / total);
+    }
+}
+
+/*!
+    @brief  replay a trace through CST816S_Dirty, in order, adding up the invalidated pixels
+*/
+static void dirty_replay(const trace_header &header, const trace_record *records, size_t count, uint32_t frameMs,
+                         uint64_t &dirtyPixels, uint64_t &fullPixels)
+{
+    CST816S_Dirty dirty(header.width, header.height, 8, frameMs);
+    uint64_t frameUs = (uint64_t)frameMs * 1000;
+    uint64_t now = 0;
+    uint64_t frame = 0;
+    bool active = false;
+    dirty_rect rect;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i > 0)
+            now += (uint32_t)(records[i].timestamp - records[i - 1].timestamp);
+        if (now / frameUs != frame)
+        {
+            // frame boundary: the renderer takes the rectangle of the finished frame
+            dirty.take(rect);
+            fullPixels += active ? (uint64_t)header.width * header.height : 0;
+            active = false;
+            frame = now / frameUs;
+        }
+        if (records[i].flags & CST816S_TRACE_FLAG_ERROR)
+            continue;
+        touch_event event;
+        cst816s_trace_decode(header, records[i], event);
+        touch_point point = {0, event.event, event.x, event.y};
+        dirty.onTouchPoints(&point, 1, event.timestamp);
+        active = true;
+    }
+    dirty.take(rect);
+    fullPixels += active ? (uint64_t)header.width * header.height : 0;
+    dirtyPixels += dirty.pixels();
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::thread::hardware_concurrency();
+    uint8_t mask = CST816S_EVENT_ALL;
+    uint32_t frameMs = 0;
+    int first = 1;
+    while (first + 1 < argc && argv[first][0] == '-')
+    {
+        if (strcmp(argv[first], "-j") == 0)
+            threads = atoi(argv[first + 1]);
+        else if (strcmp(argv[first], "-m") == 0)
+            mask = strtoul(argv[first + 1], nullptr, 0);
+        else if (strcmp(argv[first], "-d") == 0)
+            frameMs = atoi(argv[first + 1]);
+        else
+            break;
+        first += 2;
+    }
+    if (threads == 0)
+        threads = 1;
+    if (first >= argc)
+    {
+        fprintf(stderr, "usage: %s [-j threads] [-m mask] [-d frame_ms] trace.bin [trace.bin ...]\n", argv[0]);
+        return 2;
+    }
+
+    stats total;
+    double seconds = 0;
+    uint64_t dirtyPixels = 0;
+    uint64_t fullPixels = 0;
+    for (int f = first; f < argc; f++)
+    {
+        int fd = open(argv[f], O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(trace_header))
+        {
+            fprintf(stderr, "%s: cannot read trace\n", argv[f]);
+            return 1;
+        }
+        void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED)
+        {
+            fprintf(stderr, "%s: mmap failed\n", argv[f]);
+            return 1;
+        }
+
+        const trace_header &header = *static_cast<const trace_header *>(map);
+        if (header.magic != CST816S_TRACE_MAGIC || header.version != CST816S_TRACE_VERSION ||
+            header.recordSize != sizeof(trace_record))
+        {
+            fprintf(stderr, "%s: not a version %d CST816S trace\n", argv[f], CST816S_TRACE_VERSION);
+            munmap(map, st.st_size);
+            return 1;
+        }
+
+        const trace_record *records = reinterpret_cast<const trace_record *>(static_cast<const uint8_t *>(map) + sizeof(trace_header));
+        size_t count = (st.st_size - sizeof(trace_header)) / sizeof(trace_record);
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+        unsigned n = count < threads ? (count ? count : 1) : threads;
+        std::vector<stats> partial(n);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < n; t++)
+        {
+            size_t begin = count * t / n;
+            size_t end = count * (t + 1) / n;
+            workers.emplace_back(analyze, std::cref(header), records, begin, end, mask, std::ref(partial[t]));
+        }
+        for (auto &worker : workers)
+            worker.join();
+        for (auto &p : partial)
+            total.merge(p);
+
+        // sum the intervals in order to get the covered time across wraps
+        uint64_t span = 0;
+        for (size_t i = 1; i < count; i++)
+            span += (uint32_t)(records[i].timestamp - records[i - 1].timestamp);
+        seconds += span / 1e6;
+
+        if (frameMs > 0)
+            dirty_replay(header, records, count, frameMs, dirtyPixels, fullPixels);
+
+        munmap(map, st.st_size);
+    }
+
+    printf("records        %llu\n", (unsigned long long)total.records);
+    printf("read errors    %llu\n", (unsigned long long)total.errors);
+    printf("duration       %.3f s\n", seconds);
+    if (seconds > 0)
+        printf("report rate    %.1f /s\n", total.records / seconds);
+    printf("down/up/contact %llu / %llu / %llu\n", (unsigned long long)total.events[0],
+           (unsigned long long)total.events[1], (unsigned long long)total.events[2]);
+    uint64_t valid = total.records - total.errors;
+    if (mask != CST816S_EVENT_ALL && valid > 0)
+        printf("wakeups (mask 0x%02x) %llu of %llu reports, %.1f%% fewer\n", mask, (unsigned long long)total.wakeups,
+               (unsigned long long)valid, 100.0 * (valid - total.wakeups) / valid);
+    if (frameMs > 0 && fullPixels > 0)
+        printf("dirty pixels (%u ms frames) %llu of %llu full-frame, %.1f%%\n", frameMs,
+               (unsigned long long)dirtyPixels, (unsigned long long)fullPixels, 100.0 * dirtyPixels / fullPixels);
+    if (total.contactIntervals > 1)
+    {
+        double mean = total.intervalSum / total.contactIntervals;
+        double var = total.intervalSumSq / total.contactIntervals - mean * mean;
+        printf("contact interval mean %.1f us, jitter (stddev) %.1f us\n", mean, var > 0 ? std::sqrt(var) : 0.0);
+    }
+
+    printf("gestures\n");
+    for (int g = 0; g < 256; g++)
+    {
+        if (total.gestures[g])
+            printf("  %-14s %12llu\n", cst816s_gesture_name(g), (unsigned long long)total.gestures[g]);
+    }
+    print_histogram("report interval", total.interval);
+    print_histogram("touch duration (down to up)", total.duration);
+    print_histogram("gesture latency (down to gesture report)", total.latency);
+    return 0;
+}
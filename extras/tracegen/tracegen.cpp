@@ -0,0 +1,310 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "tracegen.h"
+#include "CST816S_regs.h"
+
+#define EDGE_MARGIN 10.0f
+#define LONG_PRESS_US 1500000 // hold time after which the controller reports LONG_PRESS
+#define SWIPE_DETECT_PX 20.0f // displacement after which swipe reports carry the gesture
+
+/*!
+    @brief  minimum-jerk position profile, 0 to 1 with a bell shaped velocity like human reaching
+*/
+static float min_jerk(float tau)
+{
+    return tau * tau * tau * (10.0f - 15.0f * tau + 6.0f * tau * tau);
+}
+
+/*!
+    @brief  Constructor for CST816S_TraceGen
+  @param	callback
+      called with every generated record, in time order
+*/
+CST816S_TraceGen::CST816S_TraceGen(const tracegen_config &config, tracegen_callback callback, void *arg)
+{
+    _config = config;
+    _callback = callback;
+    _arg = arg;
+    _state = config.seed ? config.seed : 0x9E3779B97F4A7C15ULL; // xorshift must not start at 0
+}
+
+/*!
+    @brief  trace header matching the generated records
+*/
+void CST816S_TraceGen::header(trace_header &header) const
+{
+    cst816s_trace_header(header, _config.width, _config.height, 0);
+}
+
+/*!
+    @brief  an idle gap, possibly with a ghost touch, followed by an interaction picked by weight
+*/
+void CST816S_TraceGen::interaction()
+{
+    uint32_t pause = range(_config.idleMinMs, _config.idleMaxMs) * 1000;
+    if (uniform() < _config.ghostsPerMinute * pause / 60e6f)
+    {
+        uint32_t before = range(0, pause);
+        idle(before);
+        ghost();
+        idle(pause - before);
+    }
+    else
+    {
+        idle(pause);
+    }
+
+    uint32_t total = _config.tapWeight + _config.doubleTapWeight + _config.longPressWeight +
+                     _config.swipeWeight + _config.dragWeight;
+    if (total == 0)
+    {
+        return;
+    }
+    uint32_t pick = range(0, total - 1);
+    if (pick < _config.tapWeight)
+    {
+        tap();
+        return;
+    }
+    pick -= _config.tapWeight;
+    if (pick < _config.doubleTapWeight)
+    {
+        doubleTap();
+        return;
+    }
+    pick -= _config.doubleTapWeight;
+    if (pick < _config.longPressWeight)
+    {
+        longPress();
+        return;
+    }
+    pick -= _config.longPressWeight;
+    if (pick < _config.swipeWeight)
+    {
+        swipe(SWIPE_UP + range(0, 3));
+        return;
+    }
+    drag();
+}
+
+void CST816S_TraceGen::tap()
+{
+    float x = EDGE_MARGIN + uniform() * (_config.width - 2 * EDGE_MARGIN);
+    float y = EDGE_MARGIN + uniform() * (_config.height - 2 * EDGE_MARGIN);
+    report(0, NONE, x, y);
+    hold(x, y, range(60000, 150000), NONE);
+    report(1, SINGLE_CLICK, x, y);
+}
+
+void CST816S_TraceGen::doubleTap()
+{
+    float x = EDGE_MARGIN + uniform() * (_config.width - 2 * EDGE_MARGIN);
+    float y = EDGE_MARGIN + uniform() * (_config.height - 2 * EDGE_MARGIN);
+    report(0, NONE, x, y);
+    hold(x, y, range(50000, 120000), NONE);
+    report(1, NONE, x, y);
+    idle(range(80000, 200000));
+
+    // the second tap lands a few pixels off
+    x += normal() * 3.0f;
+    y += normal() * 3.0f;
+    report(0, NONE, x, y);
+    hold(x, y, range(50000, 120000), NONE);
+    report(1, DOUBLE_CLICK, x, y);
+}
+
+void CST816S_TraceGen::longPress()
+{
+    float x = EDGE_MARGIN + uniform() * (_config.width - 2 * EDGE_MARGIN);
+    float y = EDGE_MARGIN + uniform() * (_config.height - 2 * EDGE_MARGIN);
+    report(0, NONE, x, y);
+    hold(x, y, LONG_PRESS_US, NONE);
+    hold(x, y, range(200000, 800000), LONG_PRESS);
+    report(1, LONG_PRESS, x, y);
+}
+
+/*!
+    @brief  a straight swipe with a minimum-jerk velocity profile and a slight bow
+  @param	gesture
+      SWIPE_UP, SWIPE_DOWN, SWIPE_LEFT or SWIPE_RIGHT, the direction the finger moves
+*/
+void CST816S_TraceGen::swipe(uint8_t gesture)
+{
+    float dx = gesture == SWIPE_LEFT ? -1.0f : gesture == SWIPE_RIGHT ? 1.0f : 0.0f;
+    float dy = gesture == SWIPE_UP ? -1.0f : gesture == SWIPE_DOWN ? 1.0f : 0.0f;
+    float span = (dx != 0 ? _config.width : _config.height) - 2 * EDGE_MARGIN;
+    float length = span * (0.3f + 0.5f * uniform());
+
+    // start where the whole swipe stays on the panel
+    float x = EDGE_MARGIN + uniform() * (_config.width - 2 * EDGE_MARGIN - (dx != 0 ? length : 0));
+    float y = EDGE_MARGIN + uniform() * (_config.height - 2 * EDGE_MARGIN - (dy != 0 ? length : 0));
+    if (dx < 0)
+    {
+        x += length;
+    }
+    if (dy < 0)
+    {
+        y += length;
+    }
+    float bow = normal() * 0.05f * length;
+    uint32_t duration = range(120000, 350000);
+
+    // positions follow the time of each report, including its jitter
+    uint64_t start = _time;
+    report(0, NONE, x, y);
+    uint8_t reported = NONE;
+    while (_time < start + duration)
+    {
+        float tau = (float)(_time - start) / duration;
+        float along = length * min_jerk(tau);
+        float across = bow * 4.0f * tau * (1.0f - tau);
+        if (along > SWIPE_DETECT_PX)
+        {
+            reported = gesture;
+        }
+        report(2, reported, x + dx * along - dy * across, y + dy * along + dx * across);
+    }
+    report(1, gesture, x + dx * length, y + dy * length);
+}
+
+/*!
+    @brief  a slow drag through a few random waypoints, no gesture
+*/
+void CST816S_TraceGen::drag()
+{
+    float x = EDGE_MARGIN + uniform() * (_config.width - 2 * EDGE_MARGIN);
+    float y = EDGE_MARGIN + uniform() * (_config.height - 2 * EDGE_MARGIN);
+    uint64_t start = _time;
+    report(0, NONE, x, y);
+    for (uint32_t legs = range(2, 4); legs > 0; legs--)
+    {
+        float tx = EDGE_MARGIN + uniform() * (_config.width - 2 * EDGE_MARGIN);
+        float ty = EDGE_MARGIN + uniform() * (_config.height - 2 * EDGE_MARGIN);
+        uint32_t duration = range(300000, 1000000);
+        while (_time < start + duration)
+        {
+            float s = min_jerk((float)(_time - start) / duration);
+            report(2, NONE, x + (tx - x) * s, y + (ty - y) * s);
+        }
+        // the next leg starts where this one ends, in place and time
+        start += duration;
+        x = tx;
+        y = ty;
+    }
+    report(1, NONE, x, y);
+}
+
+/*!
+    @brief  a spurious touch of one or two reports, as from a water drop or sleeve
+*/
+void CST816S_TraceGen::ghost()
+{
+    float x = uniform() * _config.width;
+    float y = uniform() * _config.height;
+    report(0, NONE, x, y);
+    if (range(0, 1))
+    {
+        report(2, NONE, x, y);
+    }
+    report(1, NONE, x, y);
+}
+
+void CST816S_TraceGen::idle(uint32_t us)
+{
+    _time += us;
+}
+
+/*!
+    @brief  emit contact reports at one place for a duration
+*/
+void CST816S_TraceGen::hold(float x, float y, uint32_t us, uint8_t gesture)
+{
+    for (uint64_t end = _time + us; _time < end;)
+    {
+        report(2, gesture, x, y);
+    }
+}
+
+/*!
+    @brief  emit one report at the current time and advance to the next report slot
+*/
+void CST816S_TraceGen::report(uint8_t event, uint8_t gesture, float x, float y)
+{
+    x += normal() * _config.noisePx;
+    y += normal() * _config.noisePx;
+    int xi = x < 0 ? 0 : x > _config.width - 1 ? _config.width - 1 : (int)(x + 0.5f);
+    int yi = y < 0 ? 0 : y > _config.height - 1 ? _config.height - 1 : (int)(y + 0.5f);
+
+    uint8_t frame[6];
+    frame[0] = gesture;
+    frame[1] = event == 1 ? 0 : 1;
+    frame[2] = CST816S_EVENT_FLAG::encode(event) | CST816S_XPOS_HIGH::encode(xi >> 8);
+    frame[3] = xi & 0xFF;
+    frame[4] = CST816S_TOUCH_ID::encode(0) | CST816S_YPOS_HIGH::encode(yi >> 8);
+    frame[5] = yi & 0xFF;
+
+    trace_record record;
+    cst816s_trace_record(record, (uint32_t)_time, frame, 0);
+    _callback(record, _arg);
+    _records++;
+    _time += interval();
+}
+
+/*!
+    @brief  time to the next report, the nominal period with uniform jitter
+*/
+uint32_t CST816S_TraceGen::interval()
+{
+    uint32_t period = 1000000UL / (_config.rateHz ? _config.rateHz : 1);
+    uint32_t jitter = _config.jitterUs < period / 2 ? _config.jitterUs : period / 2;
+    return period - jitter + range(0, 2 * jitter);
+}
+
+// xorshift64*, fixed so traces are reproducible across platforms
+uint64_t CST816S_TraceGen::next()
+{
+    _state ^= _state >> 12;
+    _state ^= _state << 25;
+    _state ^= _state >> 27;
+    return _state * 0x2545F4914F6CDD1DULL;
+}
+
+float CST816S_TraceGen::uniform()
+{
+    return (next() >> 40) * (1.0f / 16777216.0f);
+}
+
+/*!
+    @brief  approximately standard normal, sum of four uniforms (no libm, so results do not vary with it)
+*/
+float CST816S_TraceGen::normal()
+{
+    return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+}
+
+uint32_t CST816S_TraceGen::range(uint32_t lo, uint32_t hi)
+{
+    return lo + (uint32_t)(next() % ((uint64_t)hi - lo + 1));
+}
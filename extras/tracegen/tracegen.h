@@ -0,0 +1,97 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef CST816S_TRACEGEN_H
+#define CST816S_TRACEGEN_H
+
+/*
+    Procedural touch trace generator for the host. Interactions are
+    synthesized as report frames in the controller's format and handed out
+    as CST816S_trace records, one at a time, so traces of any length can be
+    streamed to a file or straight into a decoder. The same seed and
+    configuration always produce the same trace.
+*/
+
+#include <stdint.h>
+
+#include "CST816S_trace.h"
+
+struct tracegen_config
+{
+    uint16_t width = 240;
+    uint16_t height = 280;
+    uint16_t rateHz = 100;          // reports per second while touched
+    uint16_t jitterUs = 1000;       // report times vary by up to +-jitterUs
+    float noisePx = 0.8f;           // coordinate noise, standard deviation
+    float ghostsPerMinute = 1.0f;   // spurious one or two report touches
+    uint32_t idleMinMs = 200;       // pause between interactions
+    uint32_t idleMaxMs = 2000;
+    // relative frequency of the interactions picked by interaction()
+    uint8_t tapWeight = 40;
+    uint8_t doubleTapWeight = 10;
+    uint8_t longPressWeight = 5;
+    uint8_t swipeWeight = 30;
+    uint8_t dragWeight = 15;
+    uint64_t seed = 1;
+};
+
+typedef void (*tracegen_callback)(const trace_record &record, void *arg);
+
+class CST816S_TraceGen
+{
+    public:
+        CST816S_TraceGen(const tracegen_config &config, tracegen_callback callback, void *arg = nullptr);
+
+        void header(trace_header &header) const;
+
+        void interaction();
+        void tap();
+        void doubleTap();
+        void longPress();
+        void swipe(uint8_t gesture);
+        void drag();
+        void ghost();
+        void idle(uint32_t us);
+
+        uint64_t records() const { return _records; }
+        uint64_t time() const { return _time; } // us since the start, record timestamps wrap
+
+    private:
+        tracegen_config _config;
+        tracegen_callback _callback;
+        void *_arg;
+        uint64_t _state;
+        uint64_t _time = 0;
+        uint64_t _records = 0;
+
+        uint64_t next();
+        float uniform();
+        float normal();
+        uint32_t range(uint32_t lo, uint32_t hi);
+        uint32_t interval();
+        void report(uint8_t event, uint8_t gesture, float x, float y);
+        void hold(float x, float y, uint32_t us, uint8_t gesture);
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+   MIT License
+
+  Copyright (c) 2021 Felix Biego
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+/*
+    Command line front end of the trace generator.
+
+    Build on the host:
+        g++ -O2 -std=c++17 -I../.. tracegen.cpp tracegen_main.cpp -o cst816s-tracegen
+
+    Usage:
+        cst816s-tracegen [-s seed] [-n interactions] [-r rate_hz] [-j jitter_us]
+                         [-W width] [-H height] [-g ghosts_per_minute] out.bin
+
+    Writes a CST816S trace (see CST816S_trace.h) that cst816s-trace and the
+    trace decoding helpers read like a recorded one.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "tracegen.h"
+
+static void write_record(const trace_record &record, void *arg)
+{
+    fwrite(&record, sizeof(record), 1, static_cast<FILE *>(arg));
+}
+
+int main(int argc, char **argv)
+{
+    tracegen_config config;
+    unsigned long interactions = 1000;
+    int first = 1;
+    while (first + 1 < argc && argv[first][0] == '-')
+    {
+        const char *value = argv[first + 1];
+        if (strcmp(argv[first], "-s") == 0)
+            config.seed = strtoull(value, nullptr, 0);
+        else if (strcmp(argv[first], "-n") == 0)
+            interactions = strtoul(value, nullptr, 0);
+        else if (strcmp(argv[first], "-r") == 0)
+            config.rateHz = atoi(value);
+        else if (strcmp(argv[first], "-j") == 0)
+            config.jitterUs = atoi(value);
+        else if (strcmp(argv[first], "-W") == 0)
+            config.width = atoi(value);
+        else if (strcmp(argv[first], "-H") == 0)
+            config.height = atoi(value);
+        else if (strcmp(argv[first], "-g") == 0)
+            config.ghostsPerMinute = atof(value);
+        else
+            break;
+        first += 2;
+    }
+    if (first != argc - 1)
+    {
+        fprintf(stderr, "usage: %s [-s seed] [-n interactions] [-r rate_hz] [-j jitter_us] [-W width] [-H height] "
+                        "[-g ghosts_per_minute] out.bin\n", argv[0]);
+        return 2;
+    }
+
+    FILE *out = fopen(argv[first], "wb");
+    if (out == nullptr)
+    {
+        fprintf(stderr, "%s: cannot create\n", argv[first]);
+        return 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+
+    CST816S_TraceGen gen(config, write_record, out);
+    trace_header header;
+    gen.header(header);
+    fwrite(&header, sizeof(header), 1, out);
+    for (unsigned long i = 0; i < interactions; i++)
+        gen.interaction();
+
+    if (fclose(out) != 0)
+    {
+        fprintf(stderr, "%s: write failed\n", argv[first]);
+        return 1;
+    }
+    fprintf(stderr, "%llu records, %.1f s\n", (unsigned long long)gen.records(), gen.time() / 1e6);
+    return 0;
+}